@@ -1,9 +1,22 @@
-#version 460 core
+#version 450 core
 
 in vec4 fColor;
+in float fFog;
+
+// Frame-global data, Engine::FrameData in uniforms.h
+layout (std140) uniform FrameData {
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	vec4 uCameraPosition;
+	vec4 uFogColor;
+	float uTime;
+	float uFogStart;
+	float uFogEnd;
+};
 
 out vec4 FragColor;
 
 void main() {
-	FragColor = fColor;
+	FragColor = vec4(mix(fColor.rgb, uFogColor.rgb, fFog), fColor.a);
 }
\ No newline at end of file
@@ -0,0 +1,29 @@
+#version 450 core
+
+in vec4 fColor;
+in float fFog;
+in vec2 fUV;
+flat in uint fLayer;
+
+// Frame-global data, Engine::FrameData in uniforms.h
+layout (std140) uniform FrameData {
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	vec4 uCameraPosition;
+	vec4 uFogColor;
+	float uTime;
+	float uFogStart;
+	float uFogEnd;
+};
+
+// Engine::TextureArray on BLOCK_TEXTURE_UNIT, layers from Blocks::textureLayer
+layout (binding = 0) uniform sampler2DArray uBlockTextures;
+
+out vec4 FragColor;
+
+void main() {
+	vec4 texel = texture(uBlockTextures, vec3(fUV, float(fLayer)));
+	vec3 color = texel.rgb * fColor.rgb;
+	FragColor = vec4(mix(color, uFogColor.rgb, fFog), texel.a * fColor.a);
+}
@@ -0,0 +1,51 @@
+#version 450 core
+
+// Engine::PackedVertex, see core.h for the bit layout
+layout (location = 0) in uvec2 aData;
+layout (location = 2) in vec3 aChunkOrigin;
+
+// Frame-global data, Engine::FrameData in uniforms.h
+layout (std140) uniform FrameData {
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	vec4 uCameraPosition;
+	vec4 uFogColor;
+	float uTime;
+	float uFogStart;
+	float uFogEnd;
+};
+
+out vec4 fColor;
+out float fFog;
+out vec2 fUV;
+flat out uint fLayer;
+
+// Directional shading per face: +X -X +Y -Y +Z -Z
+const float faceShade[6] = float[6](0.8, 0.8, 1.0, 0.5, 0.9, 0.9);
+
+void main() {
+	uint data0 = aData.x;
+	uint data1 = aData.y;
+
+	vec3 position = vec3(data0 & 31u, (data0 >> 5) & 31u, (data0 >> 10) & 31u);
+	uint face = (data0 >> 15) & 7u;
+	float ao = float((data0 >> 18) & 3u) / 3.0;
+	// In block units along the face's own axes, side faces are turned so texture rows run down
+	// the world y axis (row 0 on top) and side textures stand upright
+	vec2 uv = vec2((data0 >> 20) & 31u, (data0 >> 25) & 31u);
+	if (face < 2u) uv = vec2(uv.y, -uv.x);			// X faces: u = y, v = z
+	else if (face >= 4u) uv = vec2(uv.x, -uv.y);	// Z faces: u = x, v = y
+	fUV = uv;
+	fLayer = data1 & 0xFFFFu;
+	uint light = (data1 >> 16) & 0xFFu;
+	float brightness = float(max(light >> 4, light & 15u)) / 15.0;
+
+	// Lighting only, the fragment shader multiplies in the block texture
+	float shade = faceShade[face] * mix(0.4, 1.0, ao) * max(brightness, 0.05);
+	fColor = vec4(vec3(shade), 1.0);
+
+	vec3 worldPosition = aChunkOrigin + position;
+	fFog = uFogEnd > uFogStart ? clamp((distance(worldPosition, uCameraPosition.xyz) - uFogStart) / (uFogEnd - uFogStart), 0.0, 1.0) : 0.0;
+	gl_Position = uViewProjection * vec4(worldPosition, 1.0);
+}
@@ -1,15 +1,27 @@
-#version 460 core
+#version 450 core
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec4 aColor;
 
 uniform mat4 uTransform;
-uniform mat4 uView;
-uniform mat4 uProjection;
+
+// Frame-global data, Engine::FrameData in uniforms.h
+layout (std140) uniform FrameData {
+	mat4 uView;
+	mat4 uProjection;
+	mat4 uViewProjection;
+	vec4 uCameraPosition;
+	vec4 uFogColor;
+	float uTime;
+	float uFogStart;
+	float uFogEnd;
+};
 
 out vec4 fColor;
+out float fFog;
 
 void main() {
 	fColor = aColor;
-	gl_Position = uProjection * uView * (uTransform * vec4(aPos, 1.0));
+	fFog = 0.0;
+	gl_Position = uViewProjection * (uTransform * vec4(aPos, 1.0));
 }
\ No newline at end of file
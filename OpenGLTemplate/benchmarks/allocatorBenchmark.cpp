@@ -0,0 +1,75 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/allocator.h"
+#include "benchmark.h"
+
+#include <random>
+
+using namespace Engine;
+
+static void printStats(const char* label, const Buffers::ArenaStats& stats) {
+	printf("%s: %zu pages, %zu allocations, %.1f / %.1f MiB used, %zu free blocks, largest free %.1f KiB, fragmentation %.3f\n",
+		label, stats.pageCount, stats.allocationCount,
+		stats.usedBytes / (1024.0 * 1024.0), stats.capacity / (1024.0 * 1024.0),
+		stats.freeBlockCount, stats.largestFreeBlock / 1024.0, stats.fragmentation);
+}
+
+// Simulates chunk mesh churn: allocate, free at random, reallocate, then defragment and verify contents
+// Usage: allocatorBenchmark [meshes] [rounds]
+int main(int argc, char** argv) {
+	const int meshCount = Benchmark::intArg(argc, argv, 1, 10000);
+	const int rounds = Benchmark::intArg(argc, argv, 2, 10);
+	const GLsizeiptr pageSize = 32 * 1024 * 1024;
+	const GLsizeiptr stride = sizeof(Vertex);
+
+	if (!Headless::createContext(64, 64)) return -1;
+
+	int result = 0;
+	{
+		Buffers::BufferArena arena(pageSize, stride);
+		std::mt19937 rng(1234);
+		std::uniform_int_distribution<int> vertexCountDist(64, 2048);
+		std::vector<Buffers::BufferArena::Handle> handles(meshCount, Buffers::BufferArena::InvalidHandle);
+		std::vector<uint32_t> tags(meshCount, 0);
+		std::vector<uint32_t> scratch;
+
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		size_t operations = 0;
+		for (int round = 0; round < rounds; round++) {
+			for (int i = 0; i < meshCount; i++) {
+				// Replace roughly half of the meshes every round after the first
+				if (round > 0 && (rng() & 1) == 0) continue;
+				arena.free(handles[i]);
+				GLsizeiptr byteSize = vertexCountDist(rng) * stride;
+				handles[i] = arena.allocate(byteSize);
+				tags[i] = (uint32_t)(round * meshCount + i);
+				// Tag the first word so we can verify the data survives defragmentation
+				arena.upload(handles[i], &tags[i], sizeof(uint32_t));
+				operations += round > 0 ? 2 : 1;
+			}
+		}
+		double churnMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+		printf("%zu allocate/free operations in %.2f ms (%.0f ops/sec)\n", operations, churnMs, operations / (churnMs / 1000.0));
+		printStats("Before defragment", arena.stats());
+
+		start = Benchmark::Clock::now();
+		arena.defragment();
+		glFinish();
+		printf("Defragment took %.2f ms\n", Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+		printStats("After defragment", arena.stats());
+
+		for (int i = 0; i < meshCount; i++) {
+			Buffers::Allocation allocation = arena.get(handles[i]);
+			uint32_t tag = 0;
+			glGetNamedBufferSubData(allocation.bufferId, allocation.offset, sizeof(uint32_t), &tag);
+			if (tag != tags[i] || allocation.offset % stride != 0) {
+				printf("Mesh %d lost its data after defragment\n", i);
+				result = -1;
+				break;
+			}
+		}
+	}
+
+	Headless::destroyContext();
+	return result;
+}
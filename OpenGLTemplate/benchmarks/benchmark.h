@@ -0,0 +1,51 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Small helpers shared by the benchmark executables
+namespace Benchmark {
+	using Clock = std::chrono::steady_clock;
+
+	inline double elapsedMs(Clock::time_point start, Clock::time_point end) {
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	// Nearest-rank percentile, samples must be sorted
+	inline double percentile(const std::vector<double>& sorted, double p) {
+		if (sorted.empty()) return 0.0;
+		size_t rank = (size_t)(p / 100.0 * (double)(sorted.size() - 1) + 0.5);
+		return sorted[std::min(rank, sorted.size() - 1)];
+	}
+
+	inline void printPercentiles(const char* label, std::vector<double> samples, const char* unit = "ms") {
+		if (samples.empty()) return;
+		std::sort(samples.begin(), samples.end());
+		double total = 0.0;
+		for (double s : samples) total += s;
+		printf("%s (%zu samples, %s): mean %.3f | p50 %.3f | p90 %.3f | p95 %.3f | p99 %.3f | max %.3f\n",
+			label, samples.size(), unit, total / (double)samples.size(),
+			percentile(samples, 50.0), percentile(samples, 90.0), percentile(samples, 95.0),
+			percentile(samples, 99.0), samples.back());
+	}
+
+	inline int intArg(int argc, char** argv, int index, int fallback) {
+		return argc > index ? std::atoi(argv[index]) : fallback;
+	}
+
+	// Copies a GLSL file adding "#define <define>" after the #version line, a unique define
+	// makes the driver's own shader cache miss so compile times are measured cold
+	inline void writeShaderVariant(const std::string& sourcePath, const std::string& targetPath, const std::string& define) {
+		std::ifstream input(sourcePath);
+		std::stringstream stream;
+		stream << input.rdbuf();
+		const std::string source = stream.str();
+		size_t lineEnd = source.find('\n');
+		std::ofstream(targetPath) << source.substr(0, lineEnd + 1) << "#define " << define << "\n" << source.substr(lineEnd + 1);
+	}
+}
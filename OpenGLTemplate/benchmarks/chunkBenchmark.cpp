@@ -0,0 +1,100 @@
+#include "core.h"
+#include "engine/chunk.h"
+#include "benchmark.h"
+#include "testTerrain.h"
+
+#include <random>
+
+using namespace Engine;
+
+// Fills chunks from generated terrain and compares palette storage against flat uint16 arrays
+// Usage: chunkBenchmark [chunksPerSide]
+int main(int argc, char** argv) {
+	const int chunksPerSide = Benchmark::intArg(argc, argv, 1, 8);
+	const int size = ChunkSection::SIZE;
+
+	std::vector<Chunk> chunks(chunksPerSide * chunksPerSide);
+	Benchmark::Clock::time_point start = Benchmark::Clock::now();
+	size_t sets = 0;
+	for (int i = 0; i < (int)chunks.size(); i++) {
+		Chunk& chunk = chunks[i];
+		for (int y = 0; y < chunk.height(); y++) {
+			for (int z = 0; z < size; z++) {
+				for (int x = 0; x < size; x++) {
+					chunk.set(x, y, z, testTerrainBlock((i % chunksPerSide) * size + x, y, (i / chunksPerSide) * size + z));
+					sets++;
+				}
+			}
+		}
+	}
+	double setMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+
+	size_t paletteBytes = 0, flatBytes = 0, uniformSections = 0, sectionCount = 0;
+	int bitsHistogram[17] = {};
+	for (const Chunk& chunk : chunks) {
+		paletteBytes += chunk.memoryUsage();
+		for (int s = 0; s < chunk.sectionCount(); s++) {
+			const ChunkSection& section = chunk.getSection(s);
+			flatBytes += ChunkSection::VOLUME * sizeof(uint16_t);
+			uniformSections += section.isUniform() ? 1 : 0;
+			bitsHistogram[section.getBitsPerEntry()]++;
+			sectionCount++;
+		}
+	}
+	printf("%zu chunks, %zu sections (%zu uniform), index widths: 0b %d | 1b %d | 2b %d | 4b %d | 8b %d | 16b %d\n",
+		chunks.size(), sectionCount, uniformSections,
+		bitsHistogram[0], bitsHistogram[1], bitsHistogram[2], bitsHistogram[4], bitsHistogram[8], bitsHistogram[16]);
+	printf("Palette storage %.1f KiB per chunk, flat uint16 %.1f KiB per chunk (%.1fx smaller)\n",
+		paletteBytes / 1024.0 / chunks.size(), flatBytes / 1024.0 / chunks.size(), (double)flatBytes / paletteBytes);
+	printf("set: %.1f M/sec\n", sets / (setMs / 1000.0) / 1e6);
+
+	// Random reads, checked against the generator
+	std::mt19937 rng(42);
+	const int reads = 4000000;
+	std::vector<int> coords(reads);
+	for (int& coord : coords) coord = (int)(rng() & 0x7FFFFFFF);
+	uint64_t checksum = 0;
+	start = Benchmark::Clock::now();
+	for (int coord : coords) {
+		const Chunk& chunk = chunks[coord % chunks.size()];
+		checksum += chunk.get(coord & 15, (coord >> 4) & 255, (coord >> 12) & 15);
+	}
+	double getMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+	printf("get: %.1f M/sec (checksum %llu)\n", reads / (getMs / 1000.0) / 1e6, (unsigned long long)checksum);
+
+	int result = 0;
+	for (int i = 0; i < (int)chunks.size() && result == 0; i++) {
+		for (int coord = 0; coord < 16 * 16 * 256; coord += 7) {
+			int x = coord & 15, z = (coord >> 4) & 15, y = coord >> 8;
+			if (chunks[i].get(x, y, z) != testTerrainBlock((i % chunksPerSide) * size + x, y, (i / chunksPerSide) * size + z)) {
+				printf("Chunk %d returned the wrong block at %d %d %d\n", i, x, y, z);
+				result = -1;
+				break;
+			}
+		}
+	}
+
+	// Grow a section through every index width and back down, checked against a flat copy
+	ChunkSection section;
+	std::vector<BlockId> reference(ChunkSection::VOLUME, Blocks::AIR);
+	const int distinctBlocks[] = { 3, 20, 300, 3, 1 };
+	for (int round = 0; round < 5 && result == 0; round++) {
+		for (int pass = 0; pass < 2; pass++) {
+			for (int i = 0; i < ChunkSection::VOLUME; i++) {
+				BlockId block = (BlockId)(rng() % distinctBlocks[round]);
+				section.set(i % size, i / (size * size), (i / size) % size, block);
+				reference[i] = block;
+			}
+		}
+		for (int i = 0; i < ChunkSection::VOLUME; i++) {
+			if (section.get(i % size, i / (size * size), (i / size) % size) != reference[i]) {
+				printf("Section lost block %d at %d bits per entry\n", i, section.getBitsPerEntry());
+				result = -1;
+				break;
+			}
+		}
+		printf("Churn with %3d distinct blocks: %zu palette entries, %d bits per entry, %zu bytes\n",
+			distinctBlocks[round], section.paletteSize(), section.getBitsPerEntry(), section.memoryUsage());
+	}
+	return result;
+}
@@ -0,0 +1,67 @@
+#include "core.h"
+#include "engine/culling.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+static const Cpu::Isa allIsas[] = { Cpu::Isa::Scalar, Cpu::Isa::SSE41, Cpu::Isa::AVX2 };
+
+// Culls every section within a render distance against a camera turning a full circle
+// Usage: cullBenchmark [renderDistance] [frames]
+int main(int argc, char** argv) {
+	const int renderDistance = Benchmark::intArg(argc, argv, 1, 32);
+	const int frames = Benchmark::intArg(argc, argv, 2, 360);
+	const int sectionsPerColumn = 16;
+
+	Culling::AabbList boxes;
+	for (int cz = -renderDistance; cz <= renderDistance; cz++) {
+		for (int cx = -renderDistance; cx <= renderDistance; cx++) {
+			for (int cy = 0; cy < sectionsPerColumn; cy++) {
+				glm::vec3 min = glm::vec3(cx, cy, cz) * 16.0f;
+				boxes.add(min, min + glm::vec3(16.0f));
+			}
+		}
+	}
+
+	glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, renderDistance * 16.0f);
+	std::vector<Culling::Frustum> frustums;
+	for (int frame = 0; frame < frames; frame++) {
+		float yaw = glm::radians(360.0f * frame / frames);
+		glm::vec3 eye = glm::vec3(3.0f, 80.0f, 5.0f);
+		glm::vec3 direction = glm::vec3(std::cos(yaw), -0.3f, std::sin(yaw));
+		frustums.push_back(Culling::extractFrustum(projection * glm::lookAt(eye, eye + direction, glm::vec3(0.0f, 1.0f, 0.0f))));
+	}
+	printf("%zu section AABBs, %d frames\n", boxes.size(), frames);
+
+	int result = 0;
+	std::vector<std::vector<uint32_t>> reference(frames);
+	for (Cpu::Isa isa : allIsas) {
+		if (!Cpu::isSupported(isa)) {
+			printf("%-7s not supported on this CPU\n", Cpu::isaName(isa));
+			continue;
+		}
+
+		std::vector<double> times;
+		std::vector<uint32_t> visible;
+		size_t visibleTotal = 0;
+		bool identical = true;
+		for (int frame = 0; frame < frames; frame++) {
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			Culling::cullAabbs(isa, frustums[frame], boxes, visible);
+			times.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+			visibleTotal += visible.size();
+
+			if (isa == Cpu::Isa::Scalar) reference[frame] = visible;
+			else if (visible != reference[frame]) identical = false;
+		}
+
+		char label[64];
+		snprintf(label, sizeof(label), "%-7s cull, %.1f%% visible", Cpu::isaName(isa), 100.0 * visibleTotal / ((double)boxes.size() * frames));
+		Benchmark::printPercentiles(label, times);
+		if (!identical) {
+			printf("%s visible list differs from the scalar path\n", Cpu::isaName(isa));
+			result = -1;
+		}
+	}
+	return result;
+}
@@ -0,0 +1,154 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/renderer.h"
+#include "engine/blocks.h"
+#include "engine/texture.h"
+#include "engine/renderState.h"
+#include "engine/uniforms.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+static std::vector<unsigned char> readFramebuffer(int width, int height) {
+	std::vector<unsigned char> pixels((size_t)width * height * 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return pixels;
+}
+
+// Builds a flat 16x16 patch of top faces, standing in for a chunk mesh
+static void buildChunkMesh(std::vector<PackedVertex>& vertices, std::vector<GLuint>& indices, int layer) {
+	for (int z = 0; z < 16; z++) {
+		for (int x = 0; x < 16; x++) {
+			GLuint base = (GLuint)vertices.size();
+			vertices.push_back(PackedVertex::pack(x, 0, z, FACE_POS_Y, 3, 0, 0, layer, 0xF0));
+			vertices.push_back(PackedVertex::pack(x + 1, 0, z, FACE_POS_Y, 3, 1, 0, layer, 0xF0));
+			vertices.push_back(PackedVertex::pack(x + 1, 0, z + 1, FACE_POS_Y, 3, 1, 1, layer, 0xF0));
+			vertices.push_back(PackedVertex::pack(x, 0, z + 1, FACE_POS_Y, 3, 0, 1, layer, 0xF0));
+			GLuint quad[] = { base, base + 1, base + 2, base + 2, base + 3, base };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+}
+
+// Compares one glDrawElements per chunk against ChunkRenderer's multi-draw-indirect path
+// Usage: drawBenchmark [chunksPerSide] [frames]
+int main(int argc, char** argv) {
+	const int chunksPerSide = Benchmark::intArg(argc, argv, 1, 32);
+	const int frames = Benchmark::intArg(argc, argv, 2, 100);
+	const int width = 640;
+	const int height = 360;
+
+	if (!Headless::createContext(width, height)) return -1;
+
+	int result = 0;
+	try {
+		Shader terrainShader("assets/shaders/terrainVertexShader.glsl", "assets/shaders/terrainFragmentShader.glsl");
+		TextureArray blockTextures(Blocks::texturePaths("assets/textures/blocks"));
+		ChunkRenderer renderer;
+		renderer.setBlockTextures(&blockTextures);
+
+		const int chunkCount = chunksPerSide * chunksPerSide;
+		std::vector<GLuint> vaoIDs;
+		std::vector<glm::vec3> chunkOrigins;
+		std::vector<ChunkRenderer::MeshId> meshIds;
+		GLuint indicesLen = 0;
+		for (int i = 0; i < chunkCount; i++) {
+			std::vector<PackedVertex> vertices;
+			std::vector<GLuint> indices;
+			buildChunkMesh(vertices, indices, i % Blocks::LAYER_COUNT);
+			indicesLen = (GLuint)indices.size();
+
+			GLuint vaoID = Buffers::createVAO();
+			Buffers::createVBO(vaoID, vertices.size() * sizeof(PackedVertex), vertices.data(), 0, sizeof(PackedVertex) / sizeof(float), GL_STATIC_DRAW);
+			Buffers::createEBO(vaoID, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+			Buffers::addIntegerVertexAttrib(vaoID, 0, 2, GL_UNSIGNED_INT, 0, 0);
+			vaoIDs.push_back(vaoID);
+
+			meshIds.push_back(renderer.uploadMesh(vertices.data(), vertices.size(), indices.data(), indices.size()));
+			chunkOrigins.push_back(glm::vec3((i % chunksPerSide - chunksPerSide / 2) * 16.0f, -8.0f, (i / chunksPerSide - chunksPerSide / 2) * 16.0f));
+		}
+
+		glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 64.0f, 0.1f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		glm::mat4 projectionMatrix = glm::perspective(glm::radians(90.0f), (float)width / (float)height, 0.1f, 2000.0f);
+		FrameUniforms frameUniforms;
+		frameUniforms.setCamera(viewMatrix, projectionMatrix);
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+		// Per-chunk draw calls
+		std::vector<double> submitTimes, frameTimes;
+		for (int frame = 0; frame < frames; frame++) {
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			frameUniforms.update();
+			terrainShader.use();
+			blockTextures.bind();
+			for (int i = 0; i < chunkCount; i++) {
+				Buffers::useVAO(vaoIDs[i]);
+				// The chunk origin attribute is disabled in these VAOs, so the current generic value is used
+				glVertexAttrib3fv(2, glm::value_ptr(chunkOrigins[i]));
+				glDrawElements(GL_TRIANGLES, indicesLen, GL_UNSIGNED_INT, 0);
+			}
+			submitTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+			Headless::finishFrame();
+			frameTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+		}
+		printf("%d chunks, %u triangles each, %zu vertex bytes each\n", chunkCount, indicesLen / 3, (size_t)indicesLen / 6 * 4 * sizeof(PackedVertex));
+		Benchmark::printPercentiles("glDrawElements per chunk, CPU submit", submitTimes);
+		Benchmark::printPercentiles("glDrawElements per chunk, frame", frameTimes);
+		std::vector<unsigned char> referenceImage = readFramebuffer(width, height);
+		// Guards against both paths agreeing on an empty image
+		size_t clearPixels = 0;
+		for (size_t i = 0; i < referenceImage.size(); i += 4) {
+			if (memcmp(&referenceImage[i], &referenceImage[0], 4) == 0) clearPixels++;
+		}
+		if (clearPixels == referenceImage.size() / 4) {
+			printf("Nothing was drawn\n");
+			result = -1;
+		}
+
+		// Multi-draw-indirect
+		submitTimes.clear();
+		frameTimes.clear();
+		for (int frame = 0; frame < frames; frame++) {
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			frameUniforms.update();
+			terrainShader.use();
+			renderer.beginFrame();
+			for (int i = 0; i < chunkCount; i++) {
+				renderer.addDraw(meshIds[i], chunkOrigins[i]);
+			}
+			renderer.draw();
+			submitTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+			Headless::finishFrame();
+			frameTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+		}
+		printf("ChunkRenderer: %u meshes in %u multi-draw calls, %u dropped\n", renderer.stats().meshesDrawn, renderer.stats().multiDrawCalls, renderer.stats().drawsDropped);
+		Benchmark::printPercentiles("glMultiDrawElementsIndirect, CPU submit", submitTimes);
+		Benchmark::printPercentiles("glMultiDrawElementsIndirect, frame", frameTimes);
+
+		// Both paths must produce the same image
+		if (readFramebuffer(width, height) != referenceImage) {
+			printf("Multi-draw-indirect output differs from the per-chunk path\n");
+			result = -1;
+		}
+
+		for (GLuint vaoID : vaoIDs) {
+			glDeleteVertexArrays(1, &vaoID);
+			RenderState::forgetVertexArray(vaoID);
+		}
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
@@ -0,0 +1,134 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/uniforms.h"
+#include "engine/renderState.h"
+#include "engine/framePacer.h"
+#include "benchmark.h"
+
+#include <thread>
+
+using namespace Engine;
+
+// 1. Frame cap precision: frame interval error of FramePacer (sleep + spin) against a plain
+//    sleep_until limiter at several caps, frames doing no work
+// 2. Uncapped frames with GPU work (overdrawn quads, glFlush standing in for the swap): frame rate
+//    and input-to-present latency with the driver queuing frames versus 1 and 2 frames in flight
+// Usage: framePacingBenchmark [frames]
+int main(int argc, char** argv) {
+	const int frames = Benchmark::intArg(argc, argv, 1, 120);
+	const int width = 512, height = 512;
+	int result = 0;
+
+	const double caps[] = { 60.0, 144.0, 240.0 };
+	for (double cap : caps) {
+		for (int limiter = 0; limiter < 2; limiter++) {
+			PacingSettings settings = { PresentMode::CAPPED, cap, 0, false };
+			FramePacer pacer(settings);
+			const double period = 1.0 / cap;
+			const FramePacer::Clock::duration step = std::chrono::duration_cast<FramePacer::Clock::duration>(std::chrono::duration<double>(period));
+			std::vector<double> errors;
+			FramePacer::Clock::time_point nextPoint = FramePacer::Clock::now() + step;
+			double next = FramePacer::now() + period;
+			double last = FramePacer::now();
+			for (int frame = 0; frame < frames; frame++) {
+				if (limiter == 0) std::this_thread::sleep_until(nextPoint);
+				else pacer.waitUntil(next);
+				nextPoint += step;
+				next += period;
+				double current = FramePacer::now();
+				errors.push_back(std::abs(current - last - period) * 1000.0);
+				last = current;
+			}
+			char label[64];
+			snprintf(label, sizeof(label), "%3.0f fps %-12s interval error", cap, limiter == 0 ? "sleep_until" : "sleep + spin");
+			Benchmark::printPercentiles(label, errors);
+		}
+	}
+
+	if (!Headless::createContext(width, height)) return -1;
+	try {
+		Shader shader("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+		// Full-screen quads stacked to give each frame a few ms of rasterization
+		const int layers = 24;
+		std::vector<Vertex> vertices;
+		std::vector<GLuint> indices;
+		for (int layer = 0; layer < layers; layer++) {
+			GLuint base = (GLuint)vertices.size();
+			glm::vec4 color = glm::vec4((float)layer / layers, 0.5f, 0.5f, 1.0f);
+			vertices.push_back({ glm::vec3(1.0f, -1.0f, 0.0f), color });
+			vertices.push_back({ glm::vec3(1.0f, 1.0f, 0.0f), color });
+			vertices.push_back({ glm::vec3(-1.0f, 1.0f, 0.0f), color });
+			vertices.push_back({ glm::vec3(-1.0f, -1.0f, 0.0f), color });
+			GLuint quad[] = { base, base + 1, base + 2, base + 2, base + 3, base };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+		GLuint vaoID = Buffers::createVAO();
+		Buffers::createVBO(vaoID, vertices.size() * sizeof(Vertex), vertices.data(), 0, sizeof(Vertex) / sizeof(float), GL_STATIC_DRAW);
+		Buffers::createEBO(vaoID, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+		Buffers::addVertexAttrib(vaoID, 0, 3, offsetof(Vertex, position), 0);
+		Buffers::addVertexAttrib(vaoID, 1, 4, offsetof(Vertex, color), 0);
+
+		FrameUniforms frameUniforms;
+		frameUniforms.setCamera(glm::mat4(1.0f), glm::mat4(1.0f));
+		UniformHandle<glm::mat4> transformUniform = shader.getUniform<glm::mat4>("uTransform");
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+		const int framesInFlight[] = { 0, 2, 1 };
+		double latencyQueued = 0.0, latencyOne = 0.0;
+		for (int maxFrames : framesInFlight) {
+			PacingSettings settings = { PresentMode::UNCAPPED, 0.0, maxFrames, true };
+			FramePacer pacer(settings);
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			for (int frame = 0; frame < frames; frame++) {
+				pacer.beginFrame();
+				pacer.markInputLatched();
+				glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				frameUniforms.setTime((float)frame);
+				frameUniforms.update();
+				Buffers::useVAO(vaoID);
+				shader.use();
+				Shader::set(transformUniform, glm::mat4(1.0f));
+				glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+				glFlush();
+				pacer.endFrame();
+			}
+			double ms = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+			// Let the last timestamps land
+			glFinish();
+			pacer.beginFrame();
+
+			std::vector<double> latencies = pacer.latencyMs();
+			std::sort(latencies.begin(), latencies.end());
+			double p50 = Benchmark::percentile(latencies, 50.0);
+			printf("%-18s %6.1f fps | latency p50 %6.2f ms | p99 %6.2f ms | GPU wait %.2f ms/frame\n",
+				maxFrames == 0 ? "Driver queuing" : maxFrames == 1 ? "1 frame in flight" : "2 frames in flight",
+				frames / ms * 1000.0, p50, Benchmark::percentile(latencies, 99.0), pacer.stats().gpuWaitMs / frames);
+			if (latencies.empty()) {
+				printf("  no latency samples\n");
+				result = -1;
+			}
+			if (maxFrames == 0) latencyQueued = p50;
+			if (maxFrames == 1) latencyOne = p50;
+		}
+		if (latencyOne > latencyQueued * 1.5 + 1.0) {
+			printf("Limiting frames in flight increased latency\n");
+			result = -1;
+		}
+
+		glDeleteVertexArrays(1, &vaoID);
+		RenderState::forgetVertexArray(vaoID);
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
@@ -0,0 +1,165 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/renderState.h"
+#include "engine/timestep.h"
+#include "engine/idleThrottle.h"
+#include "engine/terrain.h"
+#include "benchmark.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+using namespace Engine;
+
+// The main loop's IdleThrottle without a window: a condition variable stands in for
+// glfwWaitEventsTimeout, another thread for the window system sending focus / restore events
+// 1. CPU time per second of the loop focused (uncapped), unfocused (10 fps) and minimized (ticks only)
+// 2. Resume delay from the restore event to the next rendered frame, waking on the event versus
+//    sleeping out the timeout, with unrelated events (cursor moves) arriving meanwhile
+// Usage: idleBenchmark [secondsPerState]
+struct EventQueue {
+	std::mutex mutex;
+	std::condition_variable condition;
+	int pending = 0;
+
+	void post() {
+		std::lock_guard<std::mutex> lock(mutex);
+		pending++;
+		condition.notify_one();
+	}
+
+	// glfwWaitEventsTimeout: returns once an event is pending or the timeout passed, consumes events
+	void waitTimeout(double seconds) {
+		std::unique_lock<std::mutex> lock(mutex);
+		condition.wait_for(lock, std::chrono::duration<double>(seconds), [this]() { return pending > 0; });
+		pending = 0;
+	}
+};
+
+int main(int argc, char** argv) {
+	const double secondsPerState = Benchmark::intArg(argc, argv, 1, 2);
+	const int width = 256, height = 256;
+
+	if (!Headless::createContext(width, height)) return -1;
+
+	int result = 0;
+	try {
+		Shader shader("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+		Vertex vertices[] = {
+			{ glm::vec3(0.5f, -0.5f, 0.0f), glm::vec4(0.9f, 0.8f, 0.2f, 1.0f) },
+			{ glm::vec3(0.5f, 0.5f, 0.0f), glm::vec4(0.2f, 0.9f, 0.8f, 1.0f) },
+			{ glm::vec3(-0.5f, 0.5f, 0.0f), glm::vec4(0.8f, 0.2f, 0.9f, 1.0f) },
+			{ glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec4(0.8f, 0.9f, 0.2f, 1.0f) },
+		};
+		GLuint indices[] = { 0, 1, 2, 2, 3, 0 };
+		GLuint vaoID = Buffers::createVAO();
+		Buffers::createVBO(vaoID, sizeof(vertices), vertices, 0, sizeof(Vertex) / sizeof(float), GL_STATIC_DRAW);
+		Buffers::createEBO(vaoID, sizeof(indices), indices, GL_STATIC_DRAW);
+		Buffers::addVertexAttrib(vaoID, 0, 3, offsetof(Vertex, position), 0);
+		Buffers::addVertexAttrib(vaoID, 1, 4, offsetof(Vertex, color), 0);
+		UniformHandle<glm::mat4> transformUniform = shader.getUniform<glm::mat4>("uTransform");
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+		TerrainGenerator generator(1337);
+		Chunk chunk;
+		EventQueue events;
+		auto seconds = []() { return std::chrono::duration<double>(Benchmark::Clock::now().time_since_epoch()).count(); };
+
+		// Window state as the callbacks would keep it, written by the window system thread
+		std::atomic<bool> focused(true), iconified(false);
+		WindowEventSource windowEvents;
+		windowEvents.focused = [&]() { return focused.load(); };
+		windowEvents.iconified = [&]() { return iconified.load(); };
+		windowEvents.shouldClose = []() { return false; };
+		windowEvents.waitEvents = [&](double timeout) { events.waitTimeout(timeout); };
+		windowEvents.now = seconds;
+		// Same policy, but blind to events: every wait runs to its timeout
+		WindowEventSource sleepingEvents = windowEvents;
+		sleepingEvents.waitEvents = [](double timeout) { std::this_thread::sleep_for(std::chrono::duration<double>(timeout)); };
+		IdleThrottle throttles[2] = { IdleThrottle(sleepingEvents), IdleThrottle(windowEvents) };
+
+		// One iteration of the main loop, returns true if it rendered
+		FixedTimestep timestep;
+		double lastFrameTime = seconds();
+		auto runFrame = [&](IdleThrottle& throttle) {
+			const bool rendering = throttle.wait(timestep);
+			double now = seconds();
+			int ticks = timestep.advance(now - lastFrameTime);
+			lastFrameTime = now;
+			for (int i = 0; i < ticks; i++) generator.generate(chunk, (int)(timestep.stats().ticks % 64), 0);
+			if (!rendering) return false;
+			glClear(GL_COLOR_BUFFER_BIT);
+			Buffers::useVAO(vaoID);
+			shader.use();
+			Shader::set(transformUniform, glm::mat4(1.0f));
+			glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+			Headless::finishFrame();
+			return true;
+		};
+
+		const char* names[] = { "focused", "unfocused", "minimized" };
+		double cpuPerSecond[3] = {};
+		for (int state = 0; state < 3; state++) {
+			focused = state == 0;
+			iconified = state == 2;
+			uint64_t frames = 0, ticksBefore = timestep.stats().ticks;
+			std::clock_t cpuStart = std::clock();
+			double start = seconds();
+			while (seconds() - start < secondsPerState) {
+				if (runFrame(throttles[1])) frames++;
+			}
+			double elapsed = seconds() - start;
+			cpuPerSecond[state] = (double)(std::clock() - cpuStart) * 1000.0 / CLOCKS_PER_SEC / elapsed;
+			printf("%-10s %8.1f frames/s %6.1f ticks/s | CPU %7.1f ms/s\n", names[state], frames / elapsed,
+				(timestep.stats().ticks - ticksBefore) / elapsed, cpuPerSecond[state]);
+		}
+		if (cpuPerSecond[2] > cpuPerSecond[0] * 0.5) {
+			printf("Minimized loop did not save CPU\n");
+			result = -1;
+		}
+
+		// Restore while minimized: the window system thread posts a few cursor moves, which must not
+		// end the wait, then the restore event, the loop sees it and renders
+		focused = true;
+		for (int wakeOnEvents = 0; wakeOnEvents < 2; wakeOnEvents++) {
+			std::vector<double> delays;
+			for (int restore = 0; restore < 20; restore++) {
+				iconified = true;
+				std::atomic<double> restoreTime(0.0);
+				std::thread windowSystem([&]() {
+					for (int move = 0; move < 3; move++) {
+						std::this_thread::sleep_for(std::chrono::milliseconds(2));
+						events.post();
+					}
+					std::this_thread::sleep_for(std::chrono::milliseconds(7 + restore * 3 % 40));
+					restoreTime = seconds();
+					iconified = false;
+					events.post();
+				});
+				while (!runFrame(throttles[wakeOnEvents])) {}
+				delays.push_back((seconds() - restoreTime) * 1000.0);
+				windowSystem.join();
+			}
+			Benchmark::printPercentiles(wakeOnEvents == 1 ? "Resume, woken by the event " : "Resume, sleeping the timeout", delays);
+		}
+
+		glDeleteVertexArrays(1, &vaoID);
+		RenderState::forgetVertexArray(vaoID);
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
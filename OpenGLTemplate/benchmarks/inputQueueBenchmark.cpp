@@ -0,0 +1,107 @@
+#include "core.h"
+#include "engine/input.h"
+#include "engine/spscQueue.h"
+#include "benchmark.h"
+
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace Engine;
+using Input::InputEvent;
+
+// 1. Producer / consumer thread throughput of SpscQueue against a mutex-guarded std::deque,
+//    checking that every event arrives once and in order
+// 2. Short key taps (1000 Hz device, 20 Hz ticks): how many a tick sees when callbacks overwrite
+//    a key array versus when each tick drains the timestamped queue up to its end time
+// Usage: inputQueueBenchmark [events]
+template <typename Push, typename Pop>
+static double runThreads(int count, Push push, Pop pop, bool& ordered) {
+	Benchmark::Clock::time_point start = Benchmark::Clock::now();
+	std::thread producer([&]() {
+		for (int i = 0; i < count; i++) {
+			InputEvent event = { InputEvent::MOUSE_MOVE, 0, 0, i, (float)i, 0.0f, (double)i };
+			while (!push(event)) std::this_thread::yield();
+		}
+	});
+	ordered = true;
+	InputEvent event;
+	for (int expected = 0; expected < count; expected++) {
+		while (!pop(event)) std::this_thread::yield();
+		if (event.code != expected) ordered = false;
+	}
+	producer.join();
+	return Benchmark::elapsedMs(start, Benchmark::Clock::now());
+}
+
+int main(int argc, char** argv) {
+	const int count = Benchmark::intArg(argc, argv, 1, 2000000);
+	int result = 0;
+
+	static_assert(sizeof(InputEvent) == 24, "InputEvent should stay 24 bytes");
+	{
+		SpscQueue<InputEvent> queue(1024);
+		bool ordered;
+		double ms = runThreads(count, [&](const InputEvent& e) { return queue.push(e); }, [&](InputEvent& e) { return queue.pop(e); }, ordered);
+		printf("SpscQueue:           %.1f M events/s%s\n", count / ms * 1.0e-3, ordered ? "" : ", OUT OF ORDER");
+		if (!ordered) result = -1;
+	}
+	{
+		std::mutex mutex;
+		std::deque<InputEvent> queue;
+		bool ordered;
+		double ms = runThreads(count, [&](const InputEvent& e) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (queue.size() >= 1024) return false;
+			queue.push_back(e);
+			return true;
+		}, [&](InputEvent& e) {
+			std::lock_guard<std::mutex> lock(mutex);
+			if (queue.empty()) return false;
+			e = queue.front();
+			queue.pop_front();
+			return true;
+		}, ordered);
+		printf("mutex + std::deque:  %.1f M events/s%s\n", count / ms * 1.0e-3, ordered ? "" : ", OUT OF ORDER");
+		if (!ordered) result = -1;
+	}
+
+	// Taps of 5-45 ms every 173 ms for 60 s, callbacks run at 60 Hz polls, ticks at 20 Hz
+	const double tapLength[] = { 0.005, 0.015, 0.025, 0.035, 0.045 };
+	const double pollInterval = 1.0 / 60.0, tickInterval = 1.0 / 20.0, duration = 60.0;
+	std::vector<std::pair<double, int>> deviceEvents;	// Time, action
+	int taps = 0;
+	for (double t = 0.01; t + 0.05 < duration; t += 0.173, taps++) {
+		deviceEvents.push_back({ t, GLFW_PRESS });
+		deviceEvents.push_back({ t + tapLength[taps % 5], GLFW_RELEASE });
+	}
+
+	SpscQueue<InputEvent> queue(1024);
+	bool overwrittenState = false;
+	int seenOverwritten = 0, seenQueued = 0;
+	size_t nextDeviceEvent = 0;
+	double nextTick = tickInterval;
+	for (double poll = pollInterval; poll < duration; poll += pollInterval) {
+		// glfwPollEvents: every pending device event reaches the callback, stamped with the poll time
+		for (; nextDeviceEvent < deviceEvents.size() && deviceEvents[nextDeviceEvent].first <= poll; nextDeviceEvent++) {
+			int action = deviceEvents[nextDeviceEvent].second;
+			overwrittenState = action == GLFW_PRESS;
+			InputEvent event = { InputEvent::KEY, (uint8_t)action, 0, GLFW_KEY_SPACE, 0.0f, 0.0f, poll };
+			queue.push(event);
+		}
+		for (; nextTick <= poll; nextTick += tickInterval) {
+			if (overwrittenState) seenOverwritten++;
+			// Input::processEvents(nextTick) + wasKeyPressed
+			bool wentDown = false;
+			while (const InputEvent* event = queue.peek()) {
+				if (event->time > nextTick) break;
+				wentDown |= event->action == GLFW_PRESS;
+				queue.pop();
+			}
+			if (wentDown) seenQueued++;
+		}
+	}
+	printf("Key taps seen by the simulation: overwritten array %d / %d, event queue %d / %d\n", seenOverwritten, taps, seenQueued, taps);
+	if (seenQueued != taps) result = -1;
+	return result;
+}
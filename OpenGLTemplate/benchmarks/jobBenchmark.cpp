@@ -0,0 +1,66 @@
+#include "core.h"
+#include "engine/jobs.h"
+#include "engine/mesher.h"
+#include "benchmark.h"
+#include "testTerrain.h"
+
+#include <thread>
+
+using namespace Engine;
+
+// Generates then meshes terrain sections through the job system at 1..N workers,
+// meshing of each batch depends on its generation job through submitAfter
+// Usage: jobBenchmark [maxWorkers] [sectionsPerSide]
+int main(int argc, char** argv) {
+	const int maxWorkers = Benchmark::intArg(argc, argv, 1, std::max(4, (int)std::thread::hardware_concurrency()));
+	const int sectionsPerSide = Benchmark::intArg(argc, argv, 2, 8);
+	const int sectionCount = sectionsPerSide * sectionsPerSide * 4;
+	const int batchSize = 4;
+	const int size = Mesher::SECTION_SIZE;
+
+	std::vector<std::vector<BlockId>> sections(sectionCount, std::vector<BlockId>(Mesher::PADDED_VOLUME));
+	std::vector<Mesher::MeshData> meshes(sectionCount);
+
+	int result = 0;
+	size_t expectedTriangles = 0;
+	for (int workers = 1; workers <= maxWorkers; workers++) {
+		Jobs::init(workers);
+
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		Jobs::Counter meshed;
+		std::vector<std::unique_ptr<Jobs::Counter>> generated;
+		for (int begin = 0; begin < sectionCount; begin += batchSize) {
+			int end = std::min(sectionCount, begin + batchSize);
+			generated.push_back(std::make_unique<Jobs::Counter>());
+			Jobs::submit([&sections, begin, end, sectionsPerSide, size]() {
+				for (int i = begin; i < end; i++) {
+					int cx = (i / 4) % sectionsPerSide, cz = (i / 4) / sectionsPerSide, cy = i % 4;
+					for (int y = -1; y <= size; y++) {
+						for (int z = -1; z <= size; z++) {
+							for (int x = -1; x <= size; x++) {
+								sections[i][Mesher::paddedIndex(x, y, z)] = testTerrainBlock(cx * size + x, cy * size + y, cz * size + z);
+							}
+						}
+					}
+				}
+			}, generated.back().get());
+			Jobs::submitAfter(*generated.back(), [&sections, &meshes, begin, end]() {
+				for (int i = begin; i < end; i++) Mesher::meshGreedy(sections[i].data(), meshes[i]);
+			}, &meshed);
+		}
+		Jobs::wait(meshed);
+		double ms = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+
+		size_t triangles = 0;
+		for (const Mesher::MeshData& mesh : meshes) triangles += mesh.triangleCount();
+		printf("%2d workers: %8.0f sections/sec generated + meshed (%zu triangles)\n", workers, sectionCount / (ms / 1000.0), triangles);
+		if (expectedTriangles != 0 && triangles != expectedTriangles) {
+			printf("Triangle count differs from the 1 worker run\n");
+			result = -1;
+		}
+		expectedTriangles = triangles;
+
+		Jobs::shutdown();
+	}
+	return result;
+}
@@ -0,0 +1,126 @@
+#include "core.h"
+#include "engine/jobs.h"
+#include "engine/terrain.h"
+#include "engine/mesher.h"
+#include "engine/lod.h"
+#include "benchmark.h"
+
+#include <thread>
+
+using namespace Engine;
+
+struct MeshTotals {
+	double ms;
+	size_t triangles;
+	size_t vertexBytes;
+};
+
+// Meshes every section of every chunk, at full detail or at the level chosen for each chunk
+static MeshTotals meshAll(const std::vector<Chunk>& chunks, int chunksPerSide, const std::vector<int>& lods) {
+	const int sectionCount = chunks[0].sectionCount();
+	std::vector<size_t> triangles(chunks.size()), vertexBytes(chunks.size());
+
+	Benchmark::Clock::time_point start = Benchmark::Clock::now();
+	Jobs::Counter counter;
+	Jobs::parallelFor((int)chunks.size(), 4, [&](int begin, int end) {
+		std::vector<BlockId> padded(Mesher::PADDED_VOLUME), lodPadded(Mesher::LOD_PADDED_VOLUME);
+		Mesher::MeshData mesh;
+		for (int i = begin; i < end; i++) {
+			int cx = i % chunksPerSide, cz = i / chunksPerSide;
+			const Chunk* neighbourhood[9];
+			for (int dz = -1; dz <= 1; dz++) {
+				for (int dx = -1; dx <= 1; dx++) {
+					bool inside = cx + dx >= 0 && cz + dz >= 0 && cx + dx < chunksPerSide && cz + dz < chunksPerSide;
+					neighbourhood[(dz + 1) * 3 + (dx + 1)] = inside ? &chunks[(cz + dz) * chunksPerSide + cx + dx] : nullptr;
+				}
+			}
+
+			triangles[i] = 0;
+			vertexBytes[i] = 0;
+			for (int sectionY = 0; sectionY < sectionCount; sectionY++) {
+				const ChunkSection& section = chunks[i].getSection(sectionY);
+				if (section.isUniform() && section.get(0, 0, 0) == Blocks::AIR) continue;
+
+				if (lods[i] == 0) {
+					buildPaddedSection(neighbourhood, sectionY, padded.data());
+					Mesher::meshGreedy(padded.data(), mesh);
+				}
+				else {
+					buildLodPaddedSection(neighbourhood, sectionY, lods[i], lodPadded.data());
+					Mesher::meshGreedyLod(lodPadded.data(), lods[i], mesh);
+				}
+				triangles[i] += mesh.triangleCount();
+				vertexBytes[i] += mesh.vertices.size() * sizeof(PackedVertex) + mesh.indices.size() * sizeof(GLuint);
+			}
+		}
+	}, &counter);
+	Jobs::wait(counter);
+
+	MeshTotals totals = { Benchmark::elapsedMs(start, Benchmark::Clock::now()), 0, 0 };
+	for (size_t i = 0; i < chunks.size(); i++) {
+		totals.triangles += triangles[i];
+		totals.vertexBytes += vertexBytes[i];
+	}
+	return totals;
+}
+
+// Compares full-detail meshing of a whole view distance against per-chunk levels of detail,
+// then walks the camera across the level boundaries to count how many chunks need remeshing
+// Usage: lodBenchmark [renderDistance]
+int main(int argc, char** argv) {
+	const int renderDistance = Benchmark::intArg(argc, argv, 1, 24);
+	const int chunksPerSide = renderDistance * 2 + 1;
+	Jobs::init(0);
+
+	TerrainGenerator generator(1337);
+	std::vector<Chunk> chunks(chunksPerSide * chunksPerSide);
+	Jobs::Counter generated;
+	Jobs::parallelFor((int)chunks.size(), 4, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) generator.generate(chunks[i], i % chunksPerSide - renderDistance, i / chunksPerSide - renderDistance);
+	}, &generated);
+	Jobs::wait(generated);
+
+	const Lod::LodSettings& settings = Lod::defaultSettings;
+	glm::vec3 camera = glm::vec3(8.0f, 80.0f, 8.0f);
+	std::vector<int> fullDetail(chunks.size(), 0), selected(chunks.size());
+	int perLevel[Mesher::MAX_LOD + 1] = {};
+	for (int i = 0; i < (int)chunks.size(); i++) {
+		selected[i] = Lod::selectLod(settings, Lod::chunkDistance(camera, i % chunksPerSide - renderDistance, i / chunksPerSide - renderDistance));
+		perLevel[selected[i]]++;
+	}
+	printf("%zu chunks (render distance %d), %d workers | chunks per level: %d %d %d %d\n",
+		chunks.size(), renderDistance, Jobs::workerCount(), perLevel[0], perLevel[1], perLevel[2], perLevel[3]);
+
+	MeshTotals full = meshAll(chunks, chunksPerSide, fullDetail);
+	MeshTotals lod = meshAll(chunks, chunksPerSide, selected);
+	printf("Full detail  %9.1f ms | %9zu triangles | %8.2f MiB vertices + indices\n", full.ms, full.triangles, full.vertexBytes / (1024.0 * 1024.0));
+	printf("LOD          %9.1f ms | %9zu triangles | %8.2f MiB vertices + indices\n", lod.ms, lod.triangles, lod.vertexBytes / (1024.0 * 1024.0));
+
+	// Walk 0.25 blocks per frame, back and forth over the same stretch
+	const int frames = 1024;
+	size_t changes = 0, changesWithoutHysteresis = 0;
+	std::vector<int> current = selected, currentWithoutHysteresis = selected;
+	std::vector<double> selectTimes;
+	for (int frame = 0; frame < frames; frame++) {
+		float step = (float)(frame % 256 < 128 ? frame % 256 : 256 - frame % 256);
+		glm::vec3 position = camera + glm::vec3(step * 0.25f, 0.0f, step * 0.125f);
+
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		for (int i = 0; i < (int)chunks.size(); i++) {
+			float distance = Lod::chunkDistance(position, i % chunksPerSide - renderDistance, i / chunksPerSide - renderDistance);
+			int lodLevel = Lod::selectLod(settings, distance, current[i]);
+			changes += lodLevel != current[i] ? 1 : 0;
+			current[i] = lodLevel;
+
+			int plain = Lod::selectLod(settings, distance);
+			changesWithoutHysteresis += plain != currentWithoutHysteresis[i] ? 1 : 0;
+			currentWithoutHysteresis[i] = plain;
+		}
+		selectTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+	}
+	printf("Camera walk, %d frames: %zu level changes (%zu without hysteresis)\n", frames, changes, changesWithoutHysteresis);
+	Benchmark::printPercentiles("Per-frame level selection", selectTimes);
+
+	Jobs::shutdown();
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "core.h"
+#include "engine/mesher.h"
+#include "benchmark.h"
+#include "testTerrain.h"
+
+using namespace Engine;
+
+typedef void (*MeshFunction)(const BlockId*, Mesher::MeshData&);
+
+static void runMesher(const char* label, MeshFunction mesh, const std::vector<std::vector<BlockId>>& sections, int passes) {
+	Mesher::MeshData meshData;
+	size_t triangles = 0;
+	size_t vertexBytes = 0;
+	Benchmark::Clock::time_point start = Benchmark::Clock::now();
+	for (int pass = 0; pass < passes; pass++) {
+		triangles = 0;
+		vertexBytes = 0;
+		for (const std::vector<BlockId>& section : sections) {
+			mesh(section.data(), meshData);
+			triangles += meshData.triangleCount();
+			vertexBytes += meshData.vertices.size() * sizeof(PackedVertex);
+		}
+	}
+	double ms = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+	double sectionsPerSecond = (double)sections.size() * passes / (ms / 1000.0);
+	printf("%-8s %10.0f sections/sec | %9zu triangles | %7.2f MiB vertices\n",
+		label, sectionsPerSecond, triangles, vertexBytes / (1024.0 * 1024.0));
+}
+
+// Meshes generated terrain with the naive and the greedy mesher
+// Usage: meshBenchmark [columnsPerSide] [passes]
+int main(int argc, char** argv) {
+	const int columnsPerSide = Benchmark::intArg(argc, argv, 1, 8);
+	const int passes = Benchmark::intArg(argc, argv, 2, 5);
+	const int sectionsPerColumn = 4;
+
+	std::vector<std::vector<BlockId>> sections;
+	for (int cz = 0; cz < columnsPerSide; cz++) {
+		for (int cx = 0; cx < columnsPerSide; cx++) {
+			for (int cy = 0; cy < sectionsPerColumn; cy++) {
+				std::vector<BlockId> padded(Mesher::PADDED_VOLUME);
+				for (int y = -1; y <= Mesher::SECTION_SIZE; y++) {
+					for (int z = -1; z <= Mesher::SECTION_SIZE; z++) {
+						for (int x = -1; x <= Mesher::SECTION_SIZE; x++) {
+							padded[Mesher::paddedIndex(x, y, z)] = testTerrainBlock(
+								cx * Mesher::SECTION_SIZE + x, cy * Mesher::SECTION_SIZE + y, cz * Mesher::SECTION_SIZE + z);
+						}
+					}
+				}
+				sections.push_back(padded);
+			}
+		}
+	}
+	printf("%zu sections, %d passes\n", sections.size(), passes);
+
+	runMesher("Naive", Mesher::meshNaive, sections, passes);
+	runMesher("Greedy", Mesher::meshGreedy, sections, passes);
+	return 0;
+}
@@ -0,0 +1,165 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/uniforms.h"
+#include "engine/renderState.h"
+#include "engine/jobs.h"
+#include "engine/terrain.h"
+#include "engine/profiler.h"
+#include "benchmark.h"
+
+#include <filesystem>
+
+using namespace Engine;
+
+// Measures the cost of a CPU scope with the profiler disabled and enabled, then profiles a small
+// frame loop (terrain jobs on worker threads, GPU-timed draws), prints the last frame report and
+// exports a Chrome trace. Pass a trace path to keep the file, otherwise it goes to the temp dir
+// Usage: profilerBenchmark [frames] [tracePath]
+int main(int argc, char** argv) {
+	const int frames = Benchmark::intArg(argc, argv, 1, 60);
+	const std::string keptTracePath = argc > 2 ? argv[2] : "";
+	const int width = 512, height = 512;
+	const int scopeFrames = 50, scopesPerFrame = 10000;
+
+#ifndef ENGINE_PROFILE
+	printf("Built without ENGINE_PROFILE, the PROFILE_* macros are empty\n");
+#endif
+
+	if (!Headless::createContext(width, height)) return -1;
+
+	int result = 0;
+	try {
+		// Scope overhead, two nested scopes per iteration
+		for (int pass = 0; pass < 2; pass++) {
+			Profiler::setEnabled(pass == 1);
+			volatile uint32_t sink = 0;
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			for (int frame = 0; frame < scopeFrames; frame++) {
+				Profiler::beginFrame();
+				for (int i = 0; i < scopesPerFrame / 2; i++) {
+					PROFILE_SCOPE("Outer");
+					sink = sink + 1;
+					{
+						PROFILE_SCOPE("Inner");
+						sink = sink + 1;
+					}
+				}
+				Profiler::endFrame();
+			}
+			double ns = Benchmark::elapsedMs(start, Benchmark::Clock::now()) * 1.0e6 / ((double)scopeFrames * scopesPerFrame);
+			printf("Profiler %-8s %.1f ns per scope (including frame collection)\n", pass == 1 ? "enabled" : "disabled", ns);
+		}
+
+		// Instrumented frame loop
+		Shader shader("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+		const int gridSize = 32;
+		std::vector<Vertex> vertices;
+		std::vector<GLuint> indices;
+		for (int y = 0; y < gridSize; y++) {
+			for (int x = 0; x < gridSize; x++) {
+				GLuint base = (GLuint)vertices.size();
+				glm::vec3 origin = glm::vec3((float)x - gridSize / 2.0f, (float)y - gridSize / 2.0f, 0.0f);
+				glm::vec4 color = glm::vec4((float)x / gridSize, (float)y / gridSize, 0.5f, 1.0f);
+				vertices.push_back({ origin + glm::vec3(0.9f, 0.0f, 0.0f), color });
+				vertices.push_back({ origin + glm::vec3(0.9f, 0.9f, 0.0f), color });
+				vertices.push_back({ origin + glm::vec3(0.0f, 0.9f, 0.0f), color });
+				vertices.push_back({ origin, color });
+				GLuint quad[] = { base, base + 1, base + 2, base + 2, base + 3, base };
+				indices.insert(indices.end(), quad, quad + 6);
+			}
+		}
+		GLuint vaoID = Buffers::createVAO();
+		Buffers::createVBO(vaoID, vertices.size() * sizeof(Vertex), vertices.data(), 0, sizeof(Vertex) / sizeof(float), GL_STATIC_DRAW);
+		Buffers::createEBO(vaoID, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+		Buffers::addVertexAttrib(vaoID, 0, 3, offsetof(Vertex, position), 0);
+		Buffers::addVertexAttrib(vaoID, 1, 4, offsetof(Vertex, color), 0);
+
+		FrameUniforms frameUniforms;
+		frameUniforms.setCamera(glm::lookAt(glm::vec3(0.0f, 0.0f, (float)gridSize), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f)),
+			glm::perspective(glm::radians(60.0f), (float)width / (float)height, 0.1f, 1000.0f));
+		UniformHandle<glm::mat4> transformUniform = shader.getUniform<glm::mat4>("uTransform");
+		glm::mat4 transform = glm::mat4(1.0f);
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+		Jobs::init(2);
+		TerrainGenerator generator(1337);
+		std::vector<Chunk> chunks(4);
+		Profiler::setEnabled(true);
+		for (int frame = 0; frame < frames; frame++) {
+			RenderState::resetCounters();
+			Profiler::beginFrame();
+			{
+				PROFILE_SCOPE("Update");
+				Jobs::Counter generated;
+				Jobs::parallelFor((int)chunks.size(), 1, [&](int begin, int end) {
+					PROFILE_SCOPE("Generate chunk");
+					for (int i = begin; i < end; i++) generator.generate(chunks[i], frame * 4 + i, 0);
+				}, &generated);
+				Jobs::wait(generated);
+				transform = glm::rotate(transform, glm::radians(0.5f), glm::vec3(0.0f, 0.0f, 1.0f));
+			}
+			{
+				PROFILE_SCOPE("Render");
+				PROFILE_GPU_SCOPE("Render");
+				{
+					PROFILE_GPU_SCOPE("Clear");
+					glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+				}
+				{
+					PROFILE_GPU_SCOPE("Quads");
+					frameUniforms.update();
+					Buffers::useVAO(vaoID);
+					shader.use();
+					Shader::set(transformUniform, transform);
+					glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, 0);
+				}
+			}
+			{
+				PROFILE_SCOPE("Present");
+				Headless::finishFrame();
+			}
+			Profiler::endFrame();
+		}
+		Jobs::shutdown();
+		Profiler::printReport();
+
+		std::string tracePath = keptTracePath.empty()
+			? (std::filesystem::temp_directory_path() / "profilerBenchmark-trace.json").string() : keptTracePath;
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		bool written = Profiler::writeChromeTrace(tracePath);
+		double writeMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+		std::error_code error;
+		uintmax_t traceBytes = written ? std::filesystem::file_size(tracePath, error) : 0;
+		printf("Chrome trace: %.1f KiB in %.2f ms%s%s\n", traceBytes / 1024.0, writeMs,
+			keptTracePath.empty() ? "" : ", written to ", keptTracePath.c_str());
+		if (keptTracePath.empty()) std::filesystem::remove(tracePath, error);
+		if (!written || traceBytes == 0) {
+			printf("Trace export failed\n");
+			result = -1;
+		}
+#ifdef ENGINE_PROFILE
+		const Profiler::FrameReport& report = Profiler::lastReport();
+		if (report.cpuScopes.empty() || report.gpuScopes.empty()) {
+			printf("Missing CPU or GPU scopes in the last frame report\n");
+			result = -1;
+		}
+#endif
+
+		Profiler::shutdown();
+		glDeleteVertexArrays(1, &vaoID);
+		RenderState::forgetVertexArray(vaoID);
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
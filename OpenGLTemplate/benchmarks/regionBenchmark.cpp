@@ -0,0 +1,101 @@
+#include "core.h"
+#include "engine/jobs.h"
+#include "engine/terrain.h"
+#include "engine/region.h"
+#include "benchmark.h"
+
+#include <filesystem>
+
+using namespace Engine;
+
+static void printRate(const char* label, size_t chunks, double ms, size_t bytes) {
+	printf("%-22s %9.0f chunks/sec | %8.1f MiB/sec | %7.1f ms\n",
+		label, chunks / (ms / 1000.0), bytes / (1024.0 * 1024.0) / (ms / 1000.0), ms);
+}
+
+// Saves generated terrain into region files, overwrites it in place, saves edited chunks that
+// no longer fit their sectors, then reopens the files and loads and verifies everything
+// Usage: regionBenchmark [chunksPerSide]
+int main(int argc, char** argv) {
+	const int chunksPerSide = Benchmark::intArg(argc, argv, 1, 48);
+	const int half = chunksPerSide / 2;
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "regionBenchmark";
+	std::filesystem::remove_all(directory);
+	Jobs::init(0);
+
+	// Centred on the origin so negative region coordinates are covered too
+	TerrainGenerator generator(1337);
+	std::vector<Chunk> chunks(chunksPerSide * chunksPerSide);
+	Jobs::Counter generated;
+	Jobs::parallelFor((int)chunks.size(), 4, [&](int begin, int end) {
+		for (int i = begin; i < end; i++) generator.generate(chunks[i], i % chunksPerSide - half, i / chunksPerSide - half);
+	}, &generated);
+	Jobs::wait(generated);
+
+	size_t rawBytes = 0;
+	std::vector<uint8_t> serialized;
+	for (const Chunk& chunk : chunks) {
+		serialized.clear();
+		chunk.serialize(serialized);
+		rawBytes += serialized.size();
+	}
+
+	int result = 0;
+	{
+		RegionStorage storage(directory.string());
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		for (int i = 0; i < (int)chunks.size(); i++) storage.save(i % chunksPerSide - half, i / chunksPerSide - half, chunks[i]);
+		printRate("Save (new files)", chunks.size(), Benchmark::elapsedMs(start, Benchmark::Clock::now()), rawBytes);
+		size_t initialSize = storage.totalFileSize();
+
+		start = Benchmark::Clock::now();
+		for (int i = 0; i < (int)chunks.size(); i++) storage.save(i % chunksPerSide - half, i / chunksPerSide - half, chunks[i]);
+		printRate("Save (rewritten)", chunks.size(), Benchmark::elapsedMs(start, Benchmark::Clock::now()), rawBytes);
+
+		// Scatter mixed blocks through every 4th chunk so it needs more sectors than before
+		size_t edited = 0, editedBytes = 0;
+		for (int i = 0; i < (int)chunks.size(); i += 4, edited++) {
+			for (int n = 0; n < 4096; n++) {
+				int x = (n * 7) % 16, z = (n * 13) % 16, y = 8 + (n * 31) % 96;
+				chunks[i].set(x, y, z, (BlockId)(1 + n % (Blocks::COUNT - 1)));
+			}
+			serialized.clear();
+			chunks[i].serialize(serialized);
+			editedBytes += serialized.size();
+		}
+		start = Benchmark::Clock::now();
+		for (int i = 0; i < (int)chunks.size(); i += 4) storage.save(i % chunksPerSide - half, i / chunksPerSide - half, chunks[i]);
+		printRate("Save (grown, moved)", edited, Benchmark::elapsedMs(start, Benchmark::Clock::now()), editedBytes);
+
+		printf("%zu chunks in %zu region files | %.2f MiB serialized | %.2f MiB on disk, %.2f MiB after edits\n",
+			chunks.size(), storage.regionCount(), rawBytes / (1024.0 * 1024.0),
+			initialSize / (1024.0 * 1024.0), storage.totalFileSize() / (1024.0 * 1024.0));
+	}
+
+	{
+		// Fresh storage, every read goes through a new mapping
+		RegionStorage storage(directory.string());
+		std::vector<Chunk> loaded(chunks.size(), Chunk(0));
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		for (int i = 0; i < (int)chunks.size(); i++) {
+			if (!storage.load(i % chunksPerSide - half, i / chunksPerSide - half, loaded[i])) result = -1;
+		}
+		printRate("Load", chunks.size(), Benchmark::elapsedMs(start, Benchmark::Clock::now()), rawBytes);
+
+		std::vector<uint8_t> expected;
+		for (size_t i = 0; i < chunks.size(); i++) {
+			expected.clear();
+			serialized.clear();
+			chunks[i].serialize(expected);
+			loaded[i].serialize(serialized);
+			if (expected != serialized) result = -1;
+		}
+		Chunk missing;
+		if (storage.load(chunksPerSide, chunksPerSide, missing)) result = -1;
+		printf(result == 0 ? "Loaded chunks match what was saved\n" : "Loaded chunks differ from what was saved\n");
+	}
+
+	std::filesystem::remove_all(directory);
+	Jobs::shutdown();
+	return result;
+}
@@ -0,0 +1,100 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/uniforms.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+// Renders N frames of a quad grid into an offscreen framebuffer and reports frame-time percentiles
+// Usage: renderBenchmark [frames] [width] [height] [gridSize]
+int main(int argc, char** argv) {
+	const int frames = Benchmark::intArg(argc, argv, 1, 500);
+	const int width = Benchmark::intArg(argc, argv, 2, 1920);
+	const int height = Benchmark::intArg(argc, argv, 3, 1080);
+	const int gridSize = Benchmark::intArg(argc, argv, 4, 64);
+	const int warmupFrames = 10;
+
+	if (!Headless::createContext(width, height)) return -1;
+
+	Shader* shader = NULL;
+	try {
+		shader = new Shader("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		Headless::destroyContext();
+		return -1;
+	}
+
+	// Build a gridSize x gridSize field of quads in a single VBO / EBO
+	std::vector<Vertex> vertices;
+	std::vector<GLuint> indices;
+	vertices.reserve((size_t)gridSize * gridSize * 4);
+	indices.reserve((size_t)gridSize * gridSize * 6);
+	for (int y = 0; y < gridSize; y++) {
+		for (int x = 0; x < gridSize; x++) {
+			GLuint base = (GLuint)vertices.size();
+			glm::vec3 origin = glm::vec3((float)x - gridSize / 2.0f, (float)y - gridSize / 2.0f, 0.0f);
+			glm::vec4 color = glm::vec4((float)x / gridSize, (float)y / gridSize, 0.5f, 1.0f);
+			vertices.push_back({ origin + glm::vec3(0.9f, 0.0f, 0.0f), color });
+			vertices.push_back({ origin + glm::vec3(0.9f, 0.9f, 0.0f), color });
+			vertices.push_back({ origin + glm::vec3(0.0f, 0.9f, 0.0f), color });
+			vertices.push_back({ origin, color });
+			GLuint quad[] = { base, base + 1, base + 2, base + 2, base + 3, base };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+	GLuint vertexLen = sizeof(Vertex) / sizeof(float);
+	GLuint indicesLen = (GLuint)indices.size();
+
+	GLuint vaoID = Buffers::createVAO();
+	GLuint bindingIndex = 0;
+	Buffers::createVBO(vaoID, vertices.size() * sizeof(Vertex), vertices.data(), bindingIndex, vertexLen, GL_STATIC_DRAW);
+	Buffers::createEBO(vaoID, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+	Buffers::addVertexAttrib(vaoID, 0, 3, offsetof(Vertex, position), bindingIndex);		// Position
+	Buffers::addVertexAttrib(vaoID, 1, 4, offsetof(Vertex, color), bindingIndex);		// Color
+
+	glm::mat4 transformMatrix = glm::mat4(1.0f);
+	glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, (float)gridSize), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), (float)width / (float)height, 0.1f, 1000.0f);
+
+	FrameUniforms* frameUniforms = new FrameUniforms();
+	UniformHandle<glm::mat4> transformUniform = shader->getUniform<glm::mat4>("uTransform");
+	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frames);
+	for (int frame = 0; frame < warmupFrames + frames; frame++) {
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		transformMatrix = glm::rotate(transformMatrix, glm::radians(0.5f), glm::vec3(0.0f, 0.0f, 1.0f));
+
+		Buffers::useVAO(vaoID);
+		frameUniforms->setCamera(viewMatrix, projectionMatrix);
+		frameUniforms->update();
+		shader->use();
+		Shader::set(transformUniform, transformMatrix);
+		glDrawElements(GL_TRIANGLES, indicesLen, GL_UNSIGNED_INT, 0);
+
+		Headless::finishFrame();
+		if (frame >= warmupFrames) {
+			frameTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+		}
+	}
+
+	GLenum error = glGetError();
+	printf("Rendered %d frames at %dx%d, %u triangles per frame\n", frames, width, height, indicesLen / 3);
+	Benchmark::printPercentiles("Frame time", frameTimes);
+
+	delete frameUniforms;
+	delete shader;
+	Headless::destroyContext();
+	if (error != GL_NO_ERROR) {
+		printf("GL error 0x%x during benchmark\n", error);
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,72 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/programCache.h"
+#include "engine/renderState.h"
+#include "benchmark.h"
+
+#include <filesystem>
+
+using namespace Engine;
+
+// Builds the terrain program as N distinct variants (a #define nonce per variant, so the driver's
+// own shader cache cannot serve them) twice: a cold pass that compiles and fills a ProgramCache,
+// then a warm pass that loads every program from the cache. Reports startup time for both
+// Usage: shaderCacheBenchmark [variants]
+int main(int argc, char** argv) {
+	const int variants = Benchmark::intArg(argc, argv, 1, 32);
+
+	if (!Headless::createContext(64, 64)) return -1;
+
+	const std::filesystem::path root = std::filesystem::temp_directory_path()
+		/ ("shaderCacheBenchmark-" + std::to_string(Benchmark::Clock::now().time_since_epoch().count()));
+	int result = 0;
+	try {
+		std::filesystem::create_directories(root / "sources");
+		std::vector<std::pair<std::string, std::string>> paths;
+		const std::string runNonce = std::to_string(Benchmark::Clock::now().time_since_epoch().count());
+		for (int i = 0; i < variants; i++) {
+			std::string define = "VARIANT_" + runNonce + "_" + std::to_string(i);
+			std::string vertexPath = (root / "sources" / ("v" + std::to_string(i) + ".glsl")).string();
+			std::string fragmentPath = (root / "sources" / ("f" + std::to_string(i) + ".glsl")).string();
+			Benchmark::writeShaderVariant("assets/shaders/terrainVertexShader.glsl", vertexPath, define);
+			Benchmark::writeShaderVariant("assets/shaders/terrainFragmentShader.glsl", fragmentPath, define);
+			paths.emplace_back(vertexPath, fragmentPath);
+		}
+
+		ProgramCache cache((root / "programs").string());
+		if (!cache.isSupported()) printf("Program binaries not supported by this driver, both passes compile\n");
+
+		const char* labels[] = { "cold (compile + store)", "warm (load from cache) " };
+		double totals[2];
+		for (int pass = 0; pass < 2; pass++) {
+			std::vector<double> msPerProgram;
+			Benchmark::Clock::time_point passStart = Benchmark::Clock::now();
+			for (const auto& sources : paths) {
+				Benchmark::Clock::time_point start = Benchmark::Clock::now();
+				Shader shader(sources.first, sources.second, &cache);
+				msPerProgram.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+				glDeleteProgram(shader.id());
+				RenderState::forgetProgram(shader.id());
+			}
+			totals[pass] = Benchmark::elapsedMs(passStart, Benchmark::Clock::now());
+			Benchmark::printPercentiles(labels[pass], msPerProgram, "ms per program");
+		}
+		printf("Startup for %d programs: cold %.1f ms, warm %.1f ms (%.1fx), cache hits %zu, misses %zu\n",
+			variants, totals[0], totals[1], totals[0] / totals[1], cache.getHits(), cache.getMisses());
+
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(root, error);
+	Headless::destroyContext();
+	return result;
+}
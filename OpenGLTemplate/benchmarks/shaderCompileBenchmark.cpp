@@ -0,0 +1,93 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/shaderManager.h"
+#include "engine/renderState.h"
+#include "engine/terrain.h"
+#include "benchmark.h"
+
+#include <filesystem>
+
+using namespace Engine;
+
+// Startup with N terrain program variants plus world generation, done two ways: compiling each
+// Shader in turn before generating, and submitting all programs to a ShaderManager, generating,
+// then collecting them. Each pass uses fresh #define nonces so the driver's shader cache misses
+// Usage: shaderCompileBenchmark [variants] [chunksPerSide]
+int main(int argc, char** argv) {
+	const int variants = Benchmark::intArg(argc, argv, 1, 32);
+	const int chunksPerSide = Benchmark::intArg(argc, argv, 2, 6);
+
+	if (!Headless::createContext(64, 64)) return -1;
+
+	const std::filesystem::path root = std::filesystem::temp_directory_path()
+		/ ("shaderCompileBenchmark-" + std::to_string(Benchmark::Clock::now().time_since_epoch().count()));
+	int result = 0;
+	try {
+		std::filesystem::create_directories(root);
+		TerrainGenerator generator(1337);
+		std::vector<Chunk> chunks(chunksPerSide * chunksPerSide);
+		auto generateWorld = [&]() {
+			for (int i = 0; i < (int)chunks.size(); i++) {
+				generator.generate(chunks[i], i % chunksPerSide - chunksPerSide / 2, i / chunksPerSide - chunksPerSide / 2);
+			}
+		};
+
+		const std::string runNonce = std::to_string(Benchmark::Clock::now().time_since_epoch().count());
+		for (int pass = 0; pass < 2; pass++) {
+			std::vector<std::pair<std::string, std::string>> paths;
+			for (int i = 0; i < variants; i++) {
+				std::string suffix = std::to_string(pass) + "_" + std::to_string(i);
+				std::string define = "VARIANT_" + runNonce + "_" + suffix;
+				std::string vertexPath = (root / ("v" + suffix + ".glsl")).string();
+				std::string fragmentPath = (root / ("f" + suffix + ".glsl")).string();
+				Benchmark::writeShaderVariant("assets/shaders/terrainVertexShader.glsl", vertexPath, define);
+				Benchmark::writeShaderVariant("assets/shaders/terrainFragmentShader.glsl", fragmentPath, define);
+				paths.emplace_back(vertexPath, fragmentPath);
+			}
+
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			if (pass == 0) {
+				std::vector<GLuint> programs;
+				for (const auto& sources : paths) programs.push_back(Shader(sources.first, sources.second).id());
+				double compiledMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+				generateWorld();
+				double totalMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+				printf("serial:     compile %.1f ms, then world %.1f ms, startup %.1f ms\n", compiledMs, totalMs - compiledMs, totalMs);
+				for (GLuint program : programs) {
+					glDeleteProgram(program);
+					RenderState::forgetProgram(program);
+				}
+			}
+			else {
+				ShaderManager manager;
+				for (int i = 0; i < variants; i++) manager.submit(std::to_string(i), paths[i].first, paths[i].second);
+				double submittedMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+				generateWorld();
+				double worldMs = Benchmark::elapsedMs(start, Benchmark::Clock::now()) - submittedMs;
+				int ready = 0;
+				for (int i = 0; i < variants; i++) ready += manager.isReady(std::to_string(i)) ? 1 : 0;
+				Benchmark::Clock::time_point waitStart = Benchmark::Clock::now();
+				manager.finishAll();
+				double waitMs = Benchmark::elapsedMs(waitStart, Benchmark::Clock::now());
+				double totalMs = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+				printf("overlapped: submit %.1f ms, world %.1f ms, %d/%d ready, wait %.1f ms, startup %.1f ms (parallel compile %s)\n",
+					submittedMs, worldMs, ready, variants, waitMs, totalMs, manager.isParallel() ? "on" : "off");
+			}
+		}
+
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	std::error_code error;
+	std::filesystem::remove_all(root, error);
+	Headless::destroyContext();
+	return result;
+}
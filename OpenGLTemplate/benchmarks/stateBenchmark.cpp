@@ -0,0 +1,148 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/renderState.h"
+#include "engine/uniforms.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+static std::vector<unsigned char> readFramebuffer(int width, int height) {
+	std::vector<unsigned char> pixels((size_t)width * height * 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return pixels;
+}
+
+// Draws a sorted render queue of small quads where every object sets its full state (program,
+// VAO, texture, blend), the usual pattern of code that does not know what is bound. Runs it with
+// raw gl calls and through RenderState, reports CPU submit time and issued / elided state calls
+// Usage: stateBenchmark [objects] [frames]
+int main(int argc, char** argv) {
+	const int objectCount = Benchmark::intArg(argc, argv, 1, 4000);
+	const int frames = Benchmark::intArg(argc, argv, 2, 30);
+	const int width = 128, height = 128;
+	const int programCount = 2, vaoCount = 4, textureCount = 4;
+
+	if (!Headless::createContext(width, height)) return -1;
+
+	int result = 0;
+	try {
+		std::vector<Shader> shaders;
+		for (int i = 0; i < programCount; i++) shaders.emplace_back("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+
+		std::vector<GLuint> vaoIDs;
+		for (int i = 0; i < vaoCount; i++) {
+			float shade = 0.3f + 0.2f * i;
+			Vertex vertices[] = {
+				{ glm::vec3(0.5f, -0.5f, 0.0f), glm::vec4(shade, 0.8f, 0.2f, 0.5f) },
+				{ glm::vec3(0.5f, 0.5f, 0.0f), glm::vec4(0.2f, shade, 0.8f, 0.5f) },
+				{ glm::vec3(-0.5f, 0.5f, 0.0f), glm::vec4(0.8f, 0.2f, shade, 0.5f) },
+				{ glm::vec3(-0.5f, -0.5f, 0.0f), glm::vec4(shade, shade, 0.2f, 0.5f) },
+			};
+			GLuint indices[] = { 0, 1, 2, 2, 3, 0 };
+			GLuint vaoID = Buffers::createVAO();
+			Buffers::createVBO(vaoID, sizeof(vertices), vertices, 0, sizeof(Vertex) / sizeof(float), GL_STATIC_DRAW);
+			Buffers::createEBO(vaoID, sizeof(indices), indices, GL_STATIC_DRAW);
+			Buffers::addVertexAttrib(vaoID, 0, 3, offsetof(Vertex, position), 0);
+			Buffers::addVertexAttrib(vaoID, 1, 4, offsetof(Vertex, color), 0);
+			vaoIDs.push_back(vaoID);
+		}
+
+		std::vector<GLuint> textureIDs(textureCount);
+		glCreateTextures(GL_TEXTURE_2D, textureCount, textureIDs.data());
+		for (int i = 0; i < textureCount; i++) {
+			uint32_t texel = 0xFF000000u | (uint32_t)(i * 60);
+			glTextureStorage2D(textureIDs[i], 1, GL_RGBA8, 1, 1);
+			glTextureSubImage2D(textureIDs[i], 0, 0, 0, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, &texel);
+		}
+
+		// Sorted by state like a render queue: program, then VAO, then texture, transparent last
+		struct Object {
+			int program, vao, texture;
+			bool blend;
+			glm::mat4 transform;
+		};
+		std::vector<Object> objects(objectCount);
+		for (int i = 0; i < objectCount; i++) {
+			Object& object = objects[i];
+			object.program = i * programCount / objectCount;
+			object.vao = (i * programCount * vaoCount / objectCount) % vaoCount;
+			object.texture = (i / 64) % textureCount;
+			object.blend = i % 4 == 3;
+			float x = (float)(i % 64) / 32.0f - 1.0f, y = (float)(i / 64 % 64) / 32.0f - 1.0f;
+			object.transform = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(x, y, 0.0f)), glm::vec3(0.03f));
+		}
+		std::vector<UniformHandle<glm::mat4>> transformUniforms;
+		for (Shader& shader : shaders) transformUniforms.push_back(shader.getUniform<glm::mat4>("uTransform"));
+
+		FrameUniforms frameUniforms;
+		frameUniforms.update();
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+
+		std::vector<unsigned char> images[2];
+		for (int path = 0; path < 2; path++) {
+			const bool cached = path == 1;
+			RenderState::invalidate();
+			std::vector<double> submitTimes;
+			RenderState::Counters lastFrame = {};
+			for (int frame = 0; frame < frames; frame++) {
+				RenderState::resetCounters();
+				glClear(GL_COLOR_BUFFER_BIT);
+				Benchmark::Clock::time_point start = Benchmark::Clock::now();
+				uint32_t rawCalls = 0;
+				for (const Object& object : objects) {
+					if (cached) {
+						RenderState::useProgram(shaders[object.program].id());
+						RenderState::bindVertexArray(vaoIDs[object.vao]);
+						RenderState::bindTextureUnit(0, textureIDs[object.texture]);
+						RenderState::setEnabled(GL_BLEND, object.blend);
+					}
+					else {
+						glUseProgram(shaders[object.program].id());
+						glBindVertexArray(vaoIDs[object.vao]);
+						glBindTextureUnit(0, textureIDs[object.texture]);
+						if (object.blend) glEnable(GL_BLEND);
+						else glDisable(GL_BLEND);
+						rawCalls += 4;
+					}
+					Shader::set(transformUniforms[object.program], object.transform);
+					glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+				}
+				submitTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+				Headless::finishFrame();
+				lastFrame = cached ? RenderState::getCounters() : RenderState::Counters{ rawCalls, 0 };
+			}
+			images[path] = readFramebuffer(width, height);
+
+			const char* label = cached ? "RenderState, CPU submit" : "raw gl calls, CPU submit";
+			Benchmark::printPercentiles(label, submitTimes);
+			printf("  state calls per frame: %u issued, %u elided\n", lastFrame.issued, lastFrame.elided);
+		}
+		// Raw calls left GL ahead of the shadow, nothing else runs after this
+		RenderState::invalidate();
+
+		if (images[0] != images[1]) {
+			printf("RenderState output differs from the raw path\n");
+			result = -1;
+		}
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+		for (GLuint vaoID : vaoIDs) {
+			glDeleteVertexArrays(1, &vaoID);
+			RenderState::forgetVertexArray(vaoID);
+		}
+		glDeleteTextures(textureCount, textureIDs.data());
+		for (GLuint textureID : textureIDs) RenderState::forgetTexture(textureID);
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
@@ -0,0 +1,107 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/jobs.h"
+#include "engine/renderer.h"
+#include "engine/streaming.h"
+#include "benchmark.h"
+
+#include <thread>
+
+using namespace Engine;
+
+struct FlightResult {
+	std::vector<double> updateTimes;
+	double nearCoverage;
+};
+
+// Flies the camera in a straight line at a fixed frame rate. Draws are collected but not
+// rendered, llvmpipe would spend far longer rasterizing than the streamer runs
+static FlightResult fly(const TerrainGenerator& generator, const StreamingSettings& settings, int frames, float blocksPerFrame) {
+	ChunkRenderer renderer;
+	ChunkStreamer streamer(generator, renderer, nullptr, settings);
+	glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, (settings.renderDistance + 1) * 16.0f);
+	const std::chrono::microseconds frameInterval(16667);
+	const int nearDistance = 3;
+
+	FlightResult result = { {}, 0.0 };
+	size_t sectionsSubmitted = 0;
+	size_t nearDrawable = 0, nearTotal = 0;
+	Benchmark::Clock::time_point nextFrame = Benchmark::Clock::now();
+	for (int frame = 0; frame < frames; frame++) {
+		glm::vec3 eye = glm::vec3(frame * blocksPerFrame, 100.0f, 8.0f);
+		glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(1.0f, -0.3f, 0.2f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		streamer.update(view);
+		result.updateTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+
+		renderer.beginFrame();
+		sectionsSubmitted += streamer.submitDraws(Culling::extractFrustum(projection * view));
+
+		// Share of the columns right around the camera that can be drawn
+		int cameraX = (int)std::floor(eye.x / 16.0f), cameraZ = (int)std::floor(eye.z / 16.0f);
+		for (int dz = -nearDistance; dz <= nearDistance; dz++) {
+			for (int dx = -nearDistance; dx <= nearDistance; dx++) {
+				nearDrawable += streamer.isColumnDrawable(cameraX + dx, cameraZ + dz) ? 1 : 0;
+				nearTotal++;
+			}
+		}
+
+		nextFrame += frameInterval;
+		std::this_thread::sleep_until(nextFrame);
+	}
+	result.nearCoverage = (double)nearDrawable / (double)nearTotal;
+
+	const StreamingStats& stats = streamer.stats();
+	printf("  generated %zu | meshed %zu | uploaded %zu | cancelled %zu | unloaded %zu | resident %zu | %.0f sections drawn per frame\n",
+		stats.generated, stats.meshed, stats.uploaded, stats.cancelled, stats.unloaded, streamer.residentColumns(), (double)sectionsSubmitted / frames);
+	return result;
+}
+
+// Streams terrain around a camera flying at 60 fps, once with the per-frame budgets and once
+// with every job started as soon as it is known, and reports main-thread update cost,
+// how much work was thrown away and how often the area around the camera was ready
+// Usage: streamBenchmark [renderDistance] [frames] [blocksPerFrame]
+int main(int argc, char** argv) {
+	const int renderDistance = Benchmark::intArg(argc, argv, 1, 8);
+	const int frames = Benchmark::intArg(argc, argv, 2, 300);
+	const float blocksPerFrame = (float)Benchmark::intArg(argc, argv, 3, 6);
+
+	if (!Headless::createContext(320, 180)) return -1;
+	Jobs::init(0);
+
+	int result = 0;
+	try {
+		TerrainGenerator generator(1337);
+		printf("Render distance %d, %d frames at %.0f blocks per frame, %d workers\n", renderDistance, frames, blocksPerFrame, Jobs::workerCount());
+
+		StreamingSettings budgeted = defaultStreamingSettings;
+		budgeted.renderDistance = renderDistance;
+		StreamingSettings unbounded = budgeted;
+		unbounded.maxJobsPerFrame = 1 << 20;
+		unbounded.maxJobsInFlight = 1 << 20;
+		unbounded.maxUploadsPerFrame = 1 << 20;
+
+		const char* labels[] = { "Budgeted", "Unbounded" };
+		const StreamingSettings* configurations[] = { &budgeted, &unbounded };
+		for (int i = 0; i < 2; i++) {
+			printf("%s:\n", labels[i]);
+			FlightResult flight = fly(generator, *configurations[i], frames, blocksPerFrame);
+			printf("  columns within 3 chunks drawable %.1f%% of the time\n", flight.nearCoverage * 100.0);
+			Benchmark::printPercentiles("  Streamer update", flight.updateTimes);
+		}
+
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Jobs::shutdown();
+	Headless::destroyContext();
+	return result;
+}
@@ -0,0 +1,67 @@
+#include "core.h"
+#include "engine/noise.h"
+#include "engine/terrain.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+static const Noise::Isa allIsas[] = { Noise::Isa::Scalar, Noise::Isa::SSE41, Noise::Isa::AVX2 };
+
+// Generates chunks with every supported instruction set, reports chunks/sec and
+// checks that noise grids and chunk contents are bit-identical to the scalar path
+// Usage: terrainBenchmark [chunksPerSide]
+int main(int argc, char** argv) {
+	const int chunksPerSide = Benchmark::intArg(argc, argv, 1, 6);
+	const int seed = 1337;
+	int result = 0;
+
+	// Odd sizes exercise the scalar tail of the vector paths
+	const Noise::FbmSettings settings = { seed, 4, 1.0f / 37.0f, 2.0f, 0.5f };
+	const int width = 37, height = 19, depth = 23;
+	std::vector<float> reference2D(width * depth), reference3D(width * height * depth);
+	Noise::fbm2D(Noise::Isa::Scalar, settings, -123.25f, 77.5f, 0.75f, width, depth, reference2D.data());
+	Noise::fbm3D(Noise::Isa::Scalar, settings, -123.25f, -8.0f, 77.5f, 0.75f, width, height, depth, reference3D.data());
+
+	std::vector<Chunk> referenceChunks;
+	for (Noise::Isa isa : allIsas) {
+		if (!Cpu::isSupported(isa)) {
+			printf("%-7s not supported on this CPU\n", Cpu::isaName(isa));
+			continue;
+		}
+
+		std::vector<float> grid2D(width * depth), grid3D(width * height * depth);
+		Noise::fbm2D(isa, settings, -123.25f, 77.5f, 0.75f, width, depth, grid2D.data());
+		Noise::fbm3D(isa, settings, -123.25f, -8.0f, 77.5f, 0.75f, width, height, depth, grid3D.data());
+		bool identical = memcmp(grid2D.data(), reference2D.data(), grid2D.size() * sizeof(float)) == 0
+			&& memcmp(grid3D.data(), reference3D.data(), grid3D.size() * sizeof(float)) == 0;
+
+		TerrainGenerator generator(seed, isa);
+		std::vector<Chunk> chunks(chunksPerSide * chunksPerSide);
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		for (int i = 0; i < (int)chunks.size(); i++) {
+			generator.generate(chunks[i], i % chunksPerSide - chunksPerSide / 2, i / chunksPerSide - chunksPerSide / 2);
+		}
+		double ms = Benchmark::elapsedMs(start, Benchmark::Clock::now());
+
+		if (referenceChunks.empty()) {
+			referenceChunks.swap(chunks);
+		}
+		else {
+			for (size_t i = 0; i < chunks.size() && identical; i++) {
+				for (int y = 0; y < chunks[i].height() && identical; y++) {
+					for (int c = 0; c < 256; c++) {
+						if (chunks[i].get(c & 15, y, c >> 4) != referenceChunks[i].get(c & 15, y, c >> 4)) {
+							identical = false;
+							break;
+						}
+					}
+				}
+			}
+		}
+
+		printf("%-7s %8.1f chunks/sec | output %s\n", Cpu::isaName(isa), (chunksPerSide * chunksPerSide) / (ms / 1000.0),
+			identical ? "bit-identical" : "DIFFERS from scalar");
+		if (!identical) result = -1;
+	}
+	return result;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "engine/blocks.h"
+
+#include <cmath>
+
+// Deterministic rolling hills with stone / dirt / grass layers and some caves, for benchmarks
+inline Engine::BlockId testTerrainBlock(int x, int y, int z) {
+	using namespace Engine;
+	if (y <= 0) return Blocks::BEDROCK;
+	int height = 40 + (int)(12.0f * std::sin(x * 0.07f) * std::cos(z * 0.05f) + 6.0f * std::sin((x + z) * 0.13f));
+	if (y > height) return Blocks::AIR;
+	if (std::sin(x * 0.2f) * std::sin(y * 0.25f) * std::sin(z * 0.2f) > 0.6f) return Blocks::AIR;
+	if (y == height) return height < 34 ? Blocks::SAND : Blocks::GRASS;
+	if (y > height - 4) return Blocks::DIRT;
+	return Blocks::STONE;
+}
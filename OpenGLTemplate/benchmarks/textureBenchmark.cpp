@@ -0,0 +1,104 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/blocks.h"
+#include "engine/image.h"
+#include "engine/jobs.h"
+#include "engine/texture.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+// Block texture array build: PNG decode throughput serial and on the job system, array creation
+// (immutable storage + mipmaps), then checks level 0 of every layer against the decoded pixels
+// and level 1 against a 2x2 box filter of level 0
+// Usage: textureBenchmark [iterations]
+int main(int argc, char** argv) {
+	const int iterations = Benchmark::intArg(argc, argv, 1, 200);
+	const std::vector<std::string> paths = Blocks::texturePaths("assets/textures/blocks");
+
+	if (!Headless::createContext(64, 64)) return -1;
+
+	int result = 0;
+	try {
+		// Decode only
+		std::vector<Image> images;
+		size_t fileBytes = 0, pixelBytes = 0;
+		Benchmark::Clock::time_point start = Benchmark::Clock::now();
+		for (int i = 0; i < iterations; i++) {
+			images.clear();
+			for (const std::string& path : paths) images.push_back(Png::load(path));
+		}
+		double decodeMs = Benchmark::elapsedMs(start, Benchmark::Clock::now()) / iterations;
+		for (size_t i = 0; i < paths.size(); i++) {
+			std::ifstream file(paths[i], std::ios::binary | std::ios::ate);
+			fileBytes += (size_t)file.tellg();
+			pixelBytes += images[i].pixels.size();
+		}
+		printf("Decode %zu PNGs serially: %.3f ms (%zu bytes -> %zu pixel bytes, %.1f MB/s out)\n", paths.size(), decodeMs,
+			fileBytes, pixelBytes, pixelBytes / decodeMs * 1.0e-3);
+
+		// Full build, decode inline and on workers
+		for (int pass = 0; pass < 2; pass++) {
+			if (pass == 1) Jobs::init();
+			std::vector<double> times;
+			for (int i = 0; i < iterations / 10 + 1; i++) {
+				Benchmark::Clock::time_point buildStart = Benchmark::Clock::now();
+				TextureArray textures(paths);
+				glFinish();
+				times.push_back(Benchmark::elapsedMs(buildStart, Benchmark::Clock::now()));
+			}
+			char label[96];
+			snprintf(label, sizeof(label), "TextureArray build, decode %s", pass == 0 ? "inline" : "on the job system");
+			Benchmark::printPercentiles(label, times);
+		}
+		printf("Job system: %d workers\n", Jobs::workerCount());
+
+		TextureArray textures(paths);
+		GLint immutable = GL_FALSE;
+		glGetTextureParameteriv(textures.id(), GL_TEXTURE_IMMUTABLE_FORMAT, &immutable);
+		printf("%dx%d, %d layers, %d levels, immutable %s\n", textures.getWidth(), textures.getHeight(), textures.getLayers(), textures.getLevels(),
+			immutable == GL_TRUE ? "yes" : "no");
+		if (immutable != GL_TRUE || textures.getLayers() != Blocks::LAYER_COUNT || (1 << (textures.getLevels() - 1)) != std::max(textures.getWidth(), textures.getHeight())) {
+			printf("Unexpected texture layout\n");
+			result = -1;
+		}
+
+		const int width = textures.getWidth(), height = textures.getHeight();
+		const int mipWidth = std::max(1, width / 2), mipHeight = std::max(1, height / 2);
+		std::vector<uint8_t> level0((size_t)width * height * 4), level1((size_t)mipWidth * mipHeight * 4);
+		int worstMipError = 0;
+		for (int layer = 0; layer < textures.getLayers(); layer++) {
+			glGetTextureSubImage(textures.id(), 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)level0.size(), level0.data());
+			if (level0 != images[layer].pixels) {
+				printf("Layer %d level 0 differs from %s\n", layer, paths[layer].c_str());
+				result = -1;
+			}
+			glGetTextureSubImage(textures.id(), 1, 0, 0, layer, mipWidth, mipHeight, 1, GL_RGBA, GL_UNSIGNED_BYTE, (GLsizei)level1.size(), level1.data());
+			for (int y = 0; y < mipHeight; y++) {
+				for (int x = 0; x < mipWidth; x++) {
+					for (int c = 0; c < 4; c++) {
+						int sum = 0;
+						for (int dy = 0; dy < 2; dy++)
+							for (int dx = 0; dx < 2; dx++) sum += level0[((size_t)(y * 2 + dy) * width + x * 2 + dx) * 4 + c];
+						worstMipError = std::max(worstMipError, std::abs(sum / 4 - level1[((size_t)y * mipWidth + x) * 4 + c]));
+					}
+				}
+			}
+		}
+		printf("Level 1 worst difference to a 2x2 box filter: %d\n", worstMipError);
+		if (worstMipError > 2) result = -1;
+
+		Jobs::shutdown();
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
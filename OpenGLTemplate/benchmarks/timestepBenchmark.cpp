@@ -0,0 +1,81 @@
+#include "core.h"
+#include "engine/timestep.h"
+#include "engine/terrain.h"
+#include "benchmark.h"
+
+#include <random>
+
+using namespace Engine;
+
+// Drives a FixedTimestep with simulated frame times (steady rates, jitter, a long hitch) over the
+// same stretch of game time. Each tick generates a chunk as stand-in simulation work. Compares
+// against the old per-frame update: distance moved with a key held and simulation CPU per second
+// Usage: timestepBenchmark [simulatedSeconds]
+int main(int argc, char** argv) {
+	const int simulatedSeconds = Benchmark::intArg(argc, argv, 1, 10);
+	const float oldStepPerFrame = 0.1f;
+	const float speed = 6.0f;
+
+	struct Scenario {
+		const char* name;
+		double fps;
+		double jitter;			// Relative, uniform
+		double hitchSeconds;	// One stall in the middle
+	};
+	const Scenario scenarios[] = {
+		{ "30 fps", 30.0, 0.0, 0.0 },
+		{ "60 fps", 60.0, 0.0, 0.0 },
+		{ "144 fps", 144.0, 0.0, 0.0 },
+		{ "1000 fps", 1000.0, 0.0, 0.0 },
+		{ "60 fps +-50% jitter", 60.0, 0.5, 0.0 },
+		{ "60 fps, 2 s hitch", 60.0, 0.0, 2.0 },
+	};
+
+	TerrainGenerator generator(1337);
+	Chunk chunk;
+	int result = 0;
+	printf("%-20s %8s %10s %14s %8s %9s %12s %14s\n", "", "frames", "old dist", "old sim/sec", "ticks", "max/frame", "fixed dist", "fixed ms/sec");
+	for (const Scenario& scenario : scenarios) {
+		FixedTimestep timestep;
+		std::mt19937 random(7);
+		std::uniform_real_distribution<double> jitter(1.0 - scenario.jitter, 1.0 + scenario.jitter);
+
+		double time = 0.0;
+		bool hitched = false;
+		float position = 0.0f, previousPosition = 0.0f, renderPosition = 0.0f;
+		double tickMs = 0.0;
+		uint64_t frames = 0;
+		while (time < simulatedSeconds) {
+			double frameSeconds = 1.0 / scenario.fps * (scenario.jitter > 0.0 ? jitter(random) : 1.0);
+			if (!hitched && scenario.hitchSeconds > 0.0 && time >= simulatedSeconds / 2.0) {
+				frameSeconds += scenario.hitchSeconds;
+				hitched = true;
+			}
+			time += frameSeconds;
+			frames++;
+
+			int ticks = timestep.advance(frameSeconds);
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			for (int i = 0; i < ticks; i++) {
+				previousPosition = position;
+				position += speed * (float)timestep.tickSeconds();
+				generator.generate(chunk, (int)(timestep.stats().ticks % 64), 0);
+			}
+			tickMs += Benchmark::elapsedMs(start, Benchmark::Clock::now());
+			renderPosition = previousPosition + (position - previousPosition) * timestep.alpha();
+		}
+
+		const FixedTimestep::Stats& stats = timestep.stats();
+		printf("%-20s %8llu %10.1f %14.1f %8llu %9d %12.1f %14.2f\n", scenario.name, (unsigned long long)frames,
+			oldStepPerFrame * frames, frames / time, (unsigned long long)stats.ticks, stats.maxTicksInFrame,
+			renderPosition, tickMs / time);
+
+		// Away from hitches the rendered position trails real time by at most one tick
+		if (scenario.hitchSeconds == 0.0 && std::abs(renderPosition - speed * (float)time) > speed * (float)timestep.tickSeconds() * 1.01f) {
+			printf("  rendered position drifted from %.1f\n", speed * time);
+			result = -1;
+		}
+		if (stats.maxTicksInFrame > timestep.getSettings().maxTicksPerFrame) result = -1;
+	}
+	return result;
+}
@@ -0,0 +1,72 @@
+#include "core.h"
+#include "engine/headless.h"
+#include "engine/shader.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+// Sets a mat4 uniform thousands of times per frame three ways: the old by-name path
+// (glUseProgram + string hash with operator[] + glUniform*), the by-name setters, and
+// pre-resolved handles through glProgramUniform*. Reports CPU time per set
+// Usage: uniformBenchmark [setsPerFrame] [frames]
+int main(int argc, char** argv) {
+	const int setsPerFrame = Benchmark::intArg(argc, argv, 1, 10000);
+	const int frames = Benchmark::intArg(argc, argv, 2, 50);
+
+	if (!Headless::createContext(64, 64)) return -1;
+
+	int result = 0;
+	try {
+		Shader shader("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+		std::vector<glm::mat4> transforms(setsPerFrame);
+		for (int i = 0; i < setsPerFrame; i++) transforms[i] = glm::translate(glm::mat4(1.0f), glm::vec3((float)i, 0.0f, 0.0f));
+
+		// What every Shader::setXxx call used to do
+		std::unordered_map<std::string, int> legacyLocations;
+		legacyLocations["uTransform"] = glGetUniformLocation(shader.id(), "uTransform");
+		std::string transformName = "uTransform";
+		UniformHandle<glm::mat4> transformHandle = shader.getUniform<glm::mat4>("uTransform");
+		if (!transformHandle.isValid()) throw std::runtime_error("uTransform is not an active uniform");
+
+		for (int path = 0; path < 3; path++) {
+			std::vector<double> nsPerSet;
+			for (int frame = 0; frame < frames; frame++) {
+				Benchmark::Clock::time_point start = Benchmark::Clock::now();
+				for (int i = 0; i < setsPerFrame; i++) {
+					if (path == 0) {
+						glUseProgram(shader.id());
+						glUniformMatrix4fv(legacyLocations[transformName], 1, GL_FALSE, glm::value_ptr(transforms[i]));
+					}
+					else if (path == 1) {
+						shader.setMat4(transformName, transforms[i]);
+					}
+					else {
+						Shader::set(transformHandle, transforms[i]);
+					}
+				}
+				nsPerSet.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()) * 1.0e6 / setsPerFrame);
+				glUseProgram(0);
+				Headless::finishFrame();
+			}
+
+			const char* labels[] = {
+				"use + operator[] + glUniform (old setMat4)",
+				"setMat4 by name, glProgramUniform         ",
+				"UniformHandle, glProgramUniform           ",
+			};
+			Benchmark::printPercentiles(labels[path], nsPerSet, "ns per set");
+		}
+
+		if (glGetError() != GL_NO_ERROR) {
+			printf("GL error during benchmark\n");
+			result = -1;
+		}
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		result = -1;
+	}
+
+	Headless::destroyContext();
+	return result;
+}
@@ -0,0 +1,93 @@
+#include "core.h"
+#include "engine/terrain.h"
+#include "engine/mesher.h"
+#include "engine/culling.h"
+#include "engine/visibility.h"
+#include "benchmark.h"
+
+using namespace Engine;
+
+// Turns a camera full circle at the surface and underground, compares the sections with
+// geometry that frustum culling alone would draw against the visibility graph
+// Usage: visibilityBenchmark [renderDistance] [frames]
+int main(int argc, char** argv) {
+	const int renderDistance = Benchmark::intArg(argc, argv, 1, 8);
+	const int frames = Benchmark::intArg(argc, argv, 2, 120);
+	const int chunksPerSide = renderDistance * 2 + 1;
+	const int sectionsPerColumn = 16;
+
+	TerrainGenerator generator(1337);
+	std::vector<Chunk> chunks(chunksPerSide * chunksPerSide, Chunk(sectionsPerColumn));
+	for (int cz = 0; cz < chunksPerSide; cz++) {
+		for (int cx = 0; cx < chunksPerSide; cx++) {
+			generator.generate(chunks[cz * chunksPerSide + cx], cx - renderDistance, cz - renderDistance);
+		}
+	}
+
+	// Mesh every section for its connectivity, only sections with triangles count as drawn
+	VisibilityGraph graph(glm::ivec3(-renderDistance, 0, -renderDistance), glm::ivec3(chunksPerSide, sectionsPerColumn, chunksPerSide));
+	std::vector<bool> hasGeometry(graph.cellCount(), false);
+	Culling::AabbList boxes;
+	std::vector<BlockId> padded(Mesher::PADDED_VOLUME);
+	Mesher::MeshData mesh;
+	Benchmark::Clock::time_point meshStart = Benchmark::Clock::now();
+	for (int index = 0; index < (int)graph.cellCount(); index++) {
+		glm::ivec3 section = graph.sectionAt(index);
+		int cx = section.x + renderDistance, cz = section.z + renderDistance;
+		const Chunk* neighbourhood[9];
+		for (int dz = -1; dz <= 1; dz++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				bool inside = cx + dx >= 0 && cz + dz >= 0 && cx + dx < chunksPerSide && cz + dz < chunksPerSide;
+				neighbourhood[(dz + 1) * 3 + (dx + 1)] = inside ? &chunks[(cz + dz) * chunksPerSide + cx + dx] : nullptr;
+			}
+		}
+		buildPaddedSection(neighbourhood, section.y, padded.data());
+		Mesher::meshGreedy(padded.data(), mesh);
+		graph.setConnectivity(section, mesh.connectivity);
+		hasGeometry[index] = !mesh.indices.empty();
+
+		glm::vec3 min = glm::vec3(section) * (float)Mesher::SECTION_SIZE;
+		boxes.add(min, min + glm::vec3((float)Mesher::SECTION_SIZE));
+	}
+	printf("%zu sections meshed in %.1f ms, %d frames per camera\n",
+		graph.cellCount(), Benchmark::elapsedMs(meshStart, Benchmark::Clock::now()), frames);
+
+	const Chunk& centre = chunks[renderDistance * chunksPerSide + renderDistance];
+	int surfaceY = centre.height() - 1;
+	while (surfaceY > 0 && centre.get(8, surfaceY, 8) == Blocks::AIR) surfaceY--;
+	struct Camera { const char* label; glm::vec3 position; };
+	const Camera cameras[] = {
+		{ "Surface", glm::vec3(8.5f, surfaceY + 2.7f, 8.5f) },
+		{ "Underground", glm::vec3(8.5f, surfaceY - 24.5f, 8.5f) },
+	};
+
+	glm::mat4 projection = glm::perspective(glm::radians(70.0f), 16.0f / 9.0f, 0.1f, renderDistance * 16.0f * 1.5f);
+	std::vector<uint32_t> inFrustum, visible;
+	for (const Camera& camera : cameras) {
+		std::vector<double> frustumTimes, graphTimes;
+		size_t drawnBefore = 0, drawnAfter = 0;
+		for (int frame = 0; frame < frames; frame++) {
+			float yaw = glm::radians(360.0f * frame / frames);
+			glm::vec3 direction = glm::vec3(std::cos(yaw), -0.2f, std::sin(yaw));
+			Culling::Frustum frustum = Culling::extractFrustum(projection * glm::lookAt(camera.position, camera.position + direction, glm::vec3(0.0f, 1.0f, 0.0f)));
+
+			Benchmark::Clock::time_point start = Benchmark::Clock::now();
+			Culling::cullAabbs(Cpu::bestIsa(), frustum, boxes, inFrustum);
+			frustumTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+
+			start = Benchmark::Clock::now();
+			graph.findVisible(camera.position, frustum, visible);
+			graphTimes.push_back(Benchmark::elapsedMs(start, Benchmark::Clock::now()));
+
+			for (uint32_t index : inFrustum) drawnBefore += hasGeometry[index] ? 1 : 0;
+			for (uint32_t index : visible) drawnAfter += hasGeometry[index] ? 1 : 0;
+		}
+
+		printf("%s (y = %.1f): sections drawn per frame, frustum only %.1f | with visibility graph %.1f (%.1f%% culled)\n",
+			camera.label, camera.position.y, (double)drawnBefore / frames, (double)drawnAfter / frames,
+			drawnBefore > 0 ? 100.0 * (1.0 - (double)drawnAfter / drawnBefore) : 0.0);
+		Benchmark::printPercentiles("  Frustum cull    ", frustumTimes);
+		Benchmark::printPercentiles("  Visibility graph", graphTimes);
+	}
+	return 0;
+}
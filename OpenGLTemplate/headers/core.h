@@ -11,10 +11,39 @@
 #include <sstream>
 #include <iostream>
 #include <unordered_map>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
 
 namespace Engine {
 	struct Vertex {
 		glm::vec3 position;
 		glm::vec4 color;
 	};
+
+	// Block face order, also used as the normal index in PackedVertex
+	enum BlockFace {
+		FACE_POS_X, FACE_NEG_X,
+		FACE_POS_Y, FACE_NEG_Y,
+		FACE_POS_Z, FACE_NEG_Z,
+		FACE_COUNT
+	};
+
+	// 8 byte terrain vertex, decoded in terrainVertexShader.glsl
+	// data0: x:5 y:5 z:5 (section local 0-16) | face:3 | ao:2 | u:5 v:5 (0-16, in blocks)
+	// data1: texture layer:16 | light:8 (sky:4 block:4) | unused:8
+	struct PackedVertex {
+		uint32_t data0;
+		uint32_t data1;
+
+		static PackedVertex pack(int x, int y, int z, int face, int ao, int u, int v, int layer, int light) {
+			PackedVertex vertex;
+			vertex.data0 = (uint32_t)(x & 31) | ((uint32_t)(y & 31) << 5) | ((uint32_t)(z & 31) << 10)
+				| ((uint32_t)(face & 7) << 15) | ((uint32_t)(ao & 3) << 18)
+				| ((uint32_t)(u & 31) << 20) | ((uint32_t)(v & 31) << 25);
+			vertex.data1 = (uint32_t)(layer & 0xFFFF) | ((uint32_t)(light & 0xFF) << 16);
+			return vertex;
+		}
+	};
+	static_assert(sizeof(PackedVertex) == 8, "PackedVertex must stay 8 bytes");
 }
@@ -0,0 +1,84 @@
+#pragma once
+#include "core.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <tuple>
+
+namespace Engine {
+	namespace Buffers {
+		// A sub-range of one of the arena's GL buffers
+		struct Allocation {
+			GLuint bufferId;
+			GLintptr offset;
+			GLsizeiptr size;
+		};
+
+		struct ArenaStats {
+			size_t pageCount;
+			size_t allocationCount;
+			size_t freeBlockCount;
+			GLsizeiptr capacity;
+			GLsizeiptr usedBytes;
+			GLsizeiptr freeBytes;
+			GLsizeiptr largestFreeBlock;
+			// 0 when all free space is one block, approaches 1 as it is split into small holes
+			float fragmentation;
+		};
+
+		// Suballocates many small meshes out of a few large GL buffers (pages)
+		// Free space is tracked per page by offset (for coalescing) and globally by size (for best-fit)
+		// Allocations are referenced through handles because defragment() may move them
+		class BufferArena {
+		public:
+			typedef uint32_t Handle;
+			static constexpr Handle InvalidHandle = 0;
+
+		private:
+			struct Page {
+				GLuint bufferId;
+				GLsizeiptr size;
+				std::map<GLintptr, GLsizeiptr> freeBlocks;	// offset -> size
+				std::map<GLintptr, Handle> usedBlocks;		// offset -> handle
+			};
+			struct Slot {
+				uint32_t page;
+				GLintptr offset;
+				GLsizeiptr size;
+				bool live;
+			};
+
+			GLsizeiptr pageSize;
+			GLsizeiptr alignment;
+			std::vector<Page> pages;
+			std::vector<Slot> slots;
+			std::vector<Handle> freeSlots;
+			std::set<std::tuple<GLsizeiptr, uint32_t, GLintptr>> freeBySize;	// (size, page, offset)
+			GLsizeiptr usedBytes;
+
+			GLsizeiptr alignUp(GLsizeiptr value) const { return (value + alignment - 1) / alignment * alignment; }
+			uint32_t addPage(GLsizeiptr minSize);
+			void insertFreeBlock(uint32_t page, GLintptr offset, GLsizeiptr size);
+			void eraseFreeBlock(uint32_t page, GLintptr offset, GLsizeiptr size);
+
+		public:
+			// Offsets and sizes are multiples of alignment, use the vertex stride to keep baseVertex exact
+			BufferArena(GLsizeiptr pageSize, GLsizeiptr alignment = 256);
+			~BufferArena();
+			BufferArena(const BufferArena&) = delete;
+			BufferArena& operator=(const BufferArena&) = delete;
+
+			Handle allocate(GLsizeiptr byteSize);
+			void free(Handle handle);
+			void upload(Handle handle, const void* data, GLsizeiptr byteSize, GLintptr byteOffset = 0);
+			// Invalid, out of range or freed handles give an empty allocation (buffer 0, size 0)
+			Allocation get(Handle handle) const;
+
+			// Compact every fragmented page into a fresh buffer, returns true if any buffer ID or offset changed
+			bool defragment();
+			ArenaStats stats() const;
+		};
+	}
+}
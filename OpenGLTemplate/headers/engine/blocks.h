@@ -0,0 +1,38 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	typedef uint16_t BlockId;
+
+	namespace Blocks {
+		enum : BlockId {
+			AIR = 0,
+			STONE,
+			DIRT,
+			GRASS,
+			SAND,
+			BEDROCK,
+			COUNT
+		};
+
+		// Inline, the mesher calls this for every block and neighbour
+		inline bool isOpaque(BlockId block) {
+			return block != AIR && block < COUNT;
+		}
+		// Layers of the block texture array, one image each
+		enum TextureLayer {
+			LAYER_STONE,
+			LAYER_DIRT,
+			LAYER_GRASS_TOP,
+			LAYER_GRASS_SIDE,
+			LAYER_SAND,
+			LAYER_BEDROCK,
+			LAYER_COUNT
+		};
+
+		// Texture array layer for a block face, see BlockFace in core.h
+		int textureLayer(BlockId block, int face);
+		// <directory>/<layer name>.png for every layer, in layer order
+		std::vector<std::string> texturePaths(const std::string& directory);
+	}
+}
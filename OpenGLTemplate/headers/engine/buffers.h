@@ -4,10 +4,44 @@
 namespace Engine {
 	namespace Buffers {
 		GLuint createVAO();
-		void createVBO(GLuint vaoID, GLsizeiptr verticesByteSize, const void* vertices, GLuint bindingIndex, int vertexLen, GLenum usage);
+		GLuint createVBO(GLuint vaoID, GLsizeiptr verticesByteSize, const void* vertices, GLuint bindingIndex, int vertexLen, GLenum usage);
 		void addVertexAttrib(GLuint vaoID, GLuint location, GLuint attribLen, GLuint offset, GLuint bindingIndex);
-		void createEBO(GLuint vaoID, GLsizeiptr indicesByteSize, GLuint* indices, GLenum usage);
+		void addIntegerVertexAttrib(GLuint vaoID, GLuint location, GLuint attribLen, GLenum type, GLuint offset, GLuint bindingIndex);
+		GLuint createEBO(GLuint vaoID, GLsizeiptr indicesByteSize, GLuint* indices, GLenum usage);
 		void useVAO(GLuint vaoID);
 		void unbindVAO();
+
+		// Persistently mapped ring buffer for per-frame dynamic data (entities, particles, UI)
+		// The buffer is split into segments, one per frame in flight, each guarded by a fence
+		class StreamBuffer {
+		private:
+			GLuint bufferId;
+			char* mappedPtr;
+			GLsizeiptr segmentSize;
+			int segmentCount;
+			int currentSegment;
+			GLsizeiptr writeCursor;
+			std::vector<GLsync> segmentFences;
+			unsigned int stallCount;
+
+		public:
+			StreamBuffer(GLsizeiptr segmentSize, int segmentCount = 3);
+			~StreamBuffer();
+			StreamBuffer(const StreamBuffer&) = delete;
+			StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+			// Move to the next segment, waits only if the GPU is still reading it
+			void beginSegment();
+			// Reserve space in the current segment, returns a pointer to write into and its buffer offset
+			void* reserve(GLsizeiptr byteSize, GLsizeiptr alignment, GLintptr& offset);
+			// Copy data into the current segment and return its buffer offset
+			GLintptr write(const void* data, GLsizeiptr byteSize, GLsizeiptr alignment = 16);
+			// Fence the current segment once all draws reading it have been issued
+			void endSegment();
+
+			GLuint id() const { return bufferId; }
+			GLsizeiptr bytesRemaining() const { return segmentSize - writeCursor; }
+			unsigned int stalls() const { return stallCount; }
+		};
 	}
 }
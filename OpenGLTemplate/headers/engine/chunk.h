@@ -0,0 +1,103 @@
+#pragma once
+#include "core.h"
+#include "engine/blocks.h"
+
+namespace Engine {
+	// 16x16x16 blocks stored as a palette plus bit-packed palette indices
+	// Index width grows (0, 1, 2, 4, 8 bits) as blocks are added and shrinks as they disappear,
+	// a uniform section (all air / all stone) stores only its one palette entry.
+	// Sections with more than 256 distinct blocks store BlockIds directly (16 bits) and
+	// re-check whether a palette fits again after every VOLUME writes
+	class ChunkSection {
+	public:
+		static constexpr int SIZE = 16;
+		static constexpr int VOLUME = SIZE * SIZE * SIZE;
+
+	private:
+		static constexpr int DIRECT_BITS = 16;
+		static constexpr int MAX_PALETTE_BITS = 8;
+
+		std::vector<BlockId> palette;
+		std::vector<uint16_t> paletteCounts;
+		std::vector<uint64_t> data;
+		int bitsPerEntry;
+		int entriesPerWordLog2;
+		int liveEntries;
+		int directWrites;
+
+		static int blockIndex(int x, int y, int z) { return (y * SIZE + z) * SIZE + x; }
+		uint32_t getEntry(int index) const {
+			uint64_t word = data[index >> entriesPerWordLog2];
+			int shift = (index & ((1 << entriesPerWordLog2) - 1)) * bitsPerEntry;
+			return (uint32_t)(word >> shift) & ((1u << bitsPerEntry) - 1);
+		}
+		void setEntry(int index, uint32_t value) {
+			uint64_t& word = data[index >> entriesPerWordLog2];
+			int shift = (index & ((1 << entriesPerWordLog2) - 1)) * bitsPerEntry;
+			uint64_t mask = (uint64_t)((1u << bitsPerEntry) - 1) << shift;
+			word = (word & ~mask) | ((uint64_t)value << shift);
+		}
+		uint32_t addPaletteEntry(BlockId block);
+		void repack(int newBits, const std::vector<BlockId>& blocks);
+
+	public:
+		ChunkSection(BlockId fill = Blocks::AIR);
+
+		BlockId get(int x, int y, int z) const {
+			if (bitsPerEntry == 0) return palette[0];
+			uint32_t entry = getEntry(blockIndex(x, y, z));
+			return bitsPerEntry == DIRECT_BITS ? (BlockId)entry : palette[entry];
+		}
+		void set(int x, int y, int z, BlockId block);
+		void fill(BlockId block);
+		// Replace all VOLUME blocks at once (index (y * SIZE + z) * SIZE + x) at the smallest index width
+		void assign(const BlockId* blocks);
+		// Rebuild the palette from scratch at the smallest index width
+		void optimize();
+
+		bool isUniform() const { return bitsPerEntry == 0; }
+		int getBitsPerEntry() const { return bitsPerEntry; }
+		// 0 while storing BlockIds directly
+		size_t paletteSize() const { return (size_t)liveEntries; }
+		size_t memoryUsage() const;
+
+		// Appends the palette and packed indices as they are stored (little endian)
+		void serialize(std::vector<uint8_t>& out) const;
+		// Reads what serialize wrote and advances cursor, false if the data is malformed
+		bool deserialize(const uint8_t*& cursor, const uint8_t* end);
+	};
+
+	// A column of sections, x / z in [0, 16), y in [0, sectionCount * 16)
+	class Chunk {
+	private:
+		std::vector<ChunkSection> sections;
+
+	public:
+		Chunk(int sectionCount = 16);
+
+		BlockId get(int x, int y, int z) const {
+			if (y < 0 || y >= height()) return Blocks::AIR;
+			return sections[y / ChunkSection::SIZE].get(x, y % ChunkSection::SIZE, z);
+		}
+		void set(int x, int y, int z, BlockId block) {
+			if (y < 0 || y >= height()) return;
+			sections[y / ChunkSection::SIZE].set(x, y % ChunkSection::SIZE, z, block);
+		}
+		void optimize();
+
+		int sectionCount() const { return (int)sections.size(); }
+		int height() const { return (int)sections.size() * ChunkSection::SIZE; }
+		ChunkSection& getSection(int sectionY) { return sections[sectionY]; }
+		const ChunkSection& getSection(int sectionY) const { return sections[sectionY]; }
+		size_t memoryUsage() const;
+
+		void serialize(std::vector<uint8_t>& out) const;
+		bool deserialize(const uint8_t* data, size_t size);
+	};
+
+	// Fill a Mesher padded array for one section, neighbourhood is the 3x3 grid of chunks
+	// around it indexed [(dz + 1) * 3 + (dx + 1)], missing neighbours (nullptr) read as air
+	void buildPaddedSection(const Chunk* const neighbourhood[9], int sectionY, BlockId* padded);
+	// Same for Mesher::meshGreedyLod, lodPaddedIndex layout, fills the one cell (1 << lod) of padding it reads
+	void buildLodPaddedSection(const Chunk* const neighbourhood[9], int sectionY, int lod, BlockId* padded);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "core.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define ENGINE_CPU_X86
+#endif
+
+namespace Engine {
+	namespace Cpu {
+		// Instruction sets the SIMD kernels (noise, culling) are built for
+		enum class Isa {
+			Scalar,
+			SSE41,
+			AVX2
+		};
+
+		// Checked once at runtime, includes OS support for the AVX registers
+		bool isSupported(Isa isa);
+		Isa bestIsa();
+		const char* isaName(Isa isa);
+	}
+}
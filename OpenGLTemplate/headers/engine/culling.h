@@ -0,0 +1,35 @@
+#pragma once
+#include "core.h"
+#include "engine/cpu.h"
+
+namespace Engine {
+	namespace Culling {
+		// Plane normals point inwards, a point p is inside when dot(plane.xyz, p) + plane.w >= 0
+		struct Frustum {
+			glm::vec4 planes[6];
+		};
+
+		// Gribb / Hartmann plane extraction, works for any projection * view matrix
+		Frustum extractFrustum(const glm::mat4& viewProjection);
+
+		bool isAabbVisible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max);
+
+		// Boxes in structure-of-arrays layout so 4 / 8 of them are tested per instruction
+		struct AabbList {
+			std::vector<float> minX, minY, minZ;
+			std::vector<float> maxX, maxY, maxZ;
+
+			void add(const glm::vec3& min, const glm::vec3& max);
+			void clear();
+			void reserve(size_t count);
+			size_t size() const { return minX.size(); }
+		};
+
+		// Writes the indices of boxes that intersect the frustum into visible (in order), returns the count
+		size_t cullAabbs(Cpu::Isa isa, const Frustum& frustum, const AabbList& boxes, std::vector<uint32_t>& visible);
+
+		namespace Detail {
+			size_t cullAabbsAvx2(const Frustum& frustum, const AabbList& boxes, size_t end, uint32_t* visible);
+		}
+	}
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "core.h"
+
+#include <chrono>
+
+namespace Engine {
+	// VSYNC: swap interval 1, the display paces the loop
+	// UNCAPPED: swap interval 0, as many frames as the CPU and GPU allow
+	// CAPPED: swap interval 0, the CPU waits for the frame deadline (sleep, then spin the last stretch)
+	enum class PresentMode { VSYNC, UNCAPPED, CAPPED };
+
+	// maxFramesInFlight bounds how many presented frames the GPU may still be working on before the
+	// next one starts, 0 leaves it to the driver (often 2-3 frames queued, each adding latency)
+	// lateLatch asks the loop to sample input again right before the uniform upload
+	struct PacingSettings {
+		PresentMode mode;
+		double capFps;				// CAPPED only
+		int maxFramesInFlight;		// 0 - MAX_FRAMES_IN_FLIGHT
+		bool lateLatch;
+	};
+
+	const PacingSettings defaultPacing = { PresentMode::VSYNC, 0.0, 1, true };
+
+	// Paces the main loop and measures input-to-present latency. Per frame:
+	//   pacer.beginFrame();            // Waits for the GPU / the frame deadline
+	//   pollInput(); pacer.markInputLatched();
+	//   simulate(); render(); swap();
+	//   pacer.endFrame();
+	// Latency is from the last markInputLatched to the GPU finishing the frame, read back with a
+	// GL_TIMESTAMP query frames later. Scanout adds up to one refresh on top with vsync
+	// Needs a current GL context, does not touch GLFW: apply swapInterval() with glfwSwapInterval
+	class FramePacer {
+	public:
+		static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
+		static constexpr int LATENCY_HISTORY = 512;
+
+		struct Stats {
+			uint64_t frames;
+			double limiterMs;			// Total time waiting for the frame cap
+			double maxOvershootMs;		// Worst lateness of the cap wait past its deadline
+			double gpuWaitMs;			// Total time waiting on frames in flight
+			uint64_t droppedLatencies;	// Timestamps not back after LATENCY_HISTORY frames
+		};
+
+		using Clock = std::chrono::steady_clock;
+
+	private:
+		struct PendingFrame {
+			GLuint query;
+			double latchTime;
+		};
+
+		PacingSettings settings;
+		double framePeriod;
+		double deadline;
+		double latchTime;
+		uint64_t frameIndex;
+		GLsync fences[MAX_FRAMES_IN_FLIGHT];
+		std::vector<GLuint> freeQueries;
+		std::vector<PendingFrame> pendingFrames;
+		std::vector<double> latencies;		// Ring of LATENCY_HISTORY, ms
+		size_t latencyCursor;
+		double gpuToCpuOffset;
+		double lastCalibration;
+		// Sleep overshoot estimate (mean + one standard deviation of observed 1 ms sleeps)
+		double sleepEstimate;
+		double sleepMean;
+		double sleepM2;
+		uint64_t sleepCount;
+		Stats frameStats;
+
+		void calibrate();
+		void collectLatencies();
+
+	public:
+		FramePacer(const PacingSettings& settings = defaultPacing);
+		~FramePacer();
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		// Seconds on the pacer's clock (steady_clock)
+		static double now();
+
+		int swapInterval() const { return settings.mode == PresentMode::VSYNC ? 1 : 0; }
+		const PacingSettings& getSettings() const { return settings; }
+
+		// Start of a frame, before sampling input so the frame works with the freshest input
+		void beginFrame();
+		// Input for this frame was sampled now, call again when late latching
+		void markInputLatched();
+		// Right after the buffer swap
+		void endFrame();
+
+		// Sleeps in 1 ms steps while the estimated oversleep fits before target, then spins
+		void waitUntil(double target);
+
+		// Collected latencies in ms, oldest first, up to LATENCY_HISTORY
+		std::vector<double> latencyMs() const;
+		const Stats& stats() const { return frameStats; }
+		void printStats() const;
+	};
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	namespace Headless {
+		extern int framebufferWidth;
+		extern int framebufferHeight;
+		extern GLuint fboID;
+
+		// Create a surfaceless EGL context and an offscreen framebuffer to render into
+		bool createContext(int width, int height);
+		void bindFramebuffer();
+		void finishFrame();
+		void destroyContext();
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "core.h"
+#include "engine/timestep.h"
+
+#include <functional>
+
+namespace Engine {
+	// The window state and event wait an IdleThrottle works with, GLFW in the game, a stand-in
+	// in idleBenchmark. waitEvents blocks until an event arrives or the timeout passes and
+	// dispatches what arrived, so the callbacks have updated focused / iconified when it returns
+	struct WindowEventSource {
+		std::function<bool()> focused;
+		std::function<bool()> iconified;
+		std::function<bool()> shouldClose;
+		std::function<void(double seconds)> waitEvents;
+		std::function<double()> now;
+	};
+
+	struct IdleSettings {
+		double unfocusedFps;
+	};
+
+	const IdleSettings defaultIdle = { 10.0 };
+
+	// Throttles the main loop while nobody is watching. Per frame, before anything else:
+	//   bool rendering = throttle.wait(timestep);
+	// Focused it returns at once. Unfocused it blocks for one frame at unfocusedFps, minimized until
+	// the next simulation tick is due and the frame should not render. Only a focus or iconify
+	// change (or a close request) ends the wait early, other events stay queued for the frame
+	class IdleThrottle {
+	public:
+		struct Stats {
+			uint64_t idleFrames;	// Frames that waited
+			double idleSeconds;		// Total time spent waiting
+		};
+
+	private:
+		WindowEventSource source;
+		IdleSettings settings;
+		Stats frameStats;
+
+	public:
+		IdleThrottle(const WindowEventSource& source, const IdleSettings& settings = defaultIdle);
+
+		// Returns whether this frame renders, decided once so the callbacks cannot change it mid-frame
+		bool wait(const FixedTimestep& timestep);
+
+		const IdleSettings& getSettings() const { return settings; }
+		const Stats& stats() const { return frameStats; }
+	};
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	// 8-bit RGBA pixels, rows top to bottom
+	struct Image {
+		int width = 0;
+		int height = 0;
+		std::vector<uint8_t> pixels;
+	};
+
+	// Self-contained PNG decoder for texture assets
+	//   Color types: gray, RGB, palette, gray + alpha, RGBA, tRNS transparency
+	//   Bit depths: 1 / 2 / 4 / 8 for gray and palette, 8 / 16 for the rest (16 bit keeps the high byte)
+	//   Not supported: interlaced images. Chunk CRCs and the zlib checksum are not verified
+	// Errors throw std::runtime_error("ERROR::IMAGE::...")
+	namespace Png {
+		Image decode(const uint8_t* data, size_t size);
+		Image load(const std::string& path);
+	}
+}
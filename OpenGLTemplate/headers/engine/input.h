@@ -1,20 +1,50 @@
 #pragma once
 #include "core.h"
+#include "engine/spscQueue.h"
 
 namespace Engine {
 	namespace Input {
+		// One callback invocation, 24 bytes
+		struct InputEvent {
+			enum Type : uint8_t { KEY, MOUSE_BUTTON, MOUSE_MOVE, MOUSE_SCROLL };
+
+			Type type;
+			uint8_t action;		// GLFW_PRESS / GLFW_RELEASE / GLFW_REPEAT, keys and buttons
+			uint16_t mods;
+			int32_t code;		// Key or mouse button
+			float x, y;			// Cursor position or scroll offset
+			double time;		// glfwGetTime() when the callback ran
+		};
+
+		// Filled by the callbacks on the thread calling glfwPollEvents, drained by processEvents on
+		// the simulation thread, which can be a different one. Events past capacity are dropped
+		extern SpscQueue<InputEvent> events;
+
+		// State below is written only by processEvents, read it from the same thread
 		extern bool keyPressedData[GLFW_KEY_LAST];
+		extern bool keyWentDownData[GLFW_KEY_LAST];		// Pressed during the last processEvents call
 		extern bool mouseButtonPressedData[GLFW_MOUSE_BUTTON_LAST];
 		extern float mouseX;
 		extern float mouseY;
-		extern float mouseScrollX;
+		extern float mouseScrollX;		// Sum of the scroll events of the last processEvents call
 		extern float mouseScrollY;
+		// Written by keyCallback directly, the key state as of the last glfwPollEvents for late latching
+		extern bool keyHeldNowData[GLFW_KEY_LAST];
+
+		// Applies queued events up to untilTime (glfwGetTime clock) in order, so calling it before
+		// every simulation tick with the tick's end time hands each tick exactly its own input
+		// Returns the number of events applied
+		int processEvents(double untilTime);
 
-		// Handle user input
-		void handleKeyInput(glm::mat4 &t);
+		// Handle user input, called once per simulation tick so movement speed is in units per second
+		void handleKeyInput(glm::mat4 &t, float deltaSeconds);
 
 		// Utility
 		bool isKeyDown(int key);
+		// Also true for a tap pressed and released between two processEvents calls
+		bool wasKeyPressed(int key);
+		// Ignores the queue, read it on the thread polling events
+		bool isKeyHeldNow(int key);
 		bool isMouseButtonDown(int mouseButton);
 
 		// Callback
@@ -23,4 +53,4 @@ namespace Engine {
 		void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 		void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset);
 	}
-}
\ No newline at end of file
+}
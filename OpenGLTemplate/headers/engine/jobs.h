@@ -0,0 +1,55 @@
+#pragma once
+#include "core.h"
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+namespace Engine {
+	namespace Jobs {
+		typedef std::function<void()> Job;
+
+		// Counts outstanding jobs, reaches zero when every job submitted with it has finished
+		// Continuations added with submitAfter() are submitted as soon as it reaches zero
+		class Counter {
+		private:
+			std::atomic<int> value;
+			// Only taken when the count leaves or is about to reach zero, never per job
+			std::mutex continuationMutex;
+			std::vector<Job> continuations;
+			// Set once the last job has taken the continuations, later submitAfter() calls run at once
+			bool finished;
+
+			friend void submit(Job job, Counter* counter);
+			friend void submitAfter(Counter& dependency, Job job, Counter* counter);
+			friend void runJob(const Job& job, Counter* counter);
+			void increment();
+			void decrement();
+
+		public:
+			Counter() : value(0), finished(false) {}
+			Counter(const Counter&) = delete;
+			Counter& operator=(const Counter&) = delete;
+
+			// Once true, the counter can be destroyed: zero is the last write the final job makes to it
+			bool isDone() const { return value.load(std::memory_order_acquire) == 0; }
+			int pending() const { return value.load(std::memory_order_acquire); }
+		};
+
+		// Start workerCount threads (0 = one per core, minus the main thread)
+		// init() and shutdown() are called from the main thread while no other thread submits
+		void init(int workerCount = 0);
+		void shutdown();
+		int workerCount();
+
+		// Workers push to and pop from their own deque, idle workers steal from the others
+		void submit(Job job, Counter* counter = nullptr);
+		// Submit job once dependency reaches zero
+		void submitAfter(Counter& dependency, Job job, Counter* counter = nullptr);
+		// Split [0, count) into batches of batchSize, each calls function(begin, end)
+		void parallelFor(int count, int batchSize, const std::function<void(int, int)>& function, Counter* counter);
+
+		// Block until counter reaches zero, running queued jobs on the calling thread meanwhile
+		void wait(Counter& counter);
+	}
+}
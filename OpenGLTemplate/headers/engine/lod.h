@@ -0,0 +1,23 @@
+#pragma once
+#include "core.h"
+#include "engine/mesher.h"
+
+namespace Engine {
+	namespace Lod {
+		// Horizontal distances in chunks, level k + 1 starts at startDistance[k]
+		// A chunk only changes level once it is hysteresis chunks past a boundary, so a camera
+		// moving along a boundary does not remesh the same chunks every frame
+		struct LodSettings {
+			float startDistance[Mesher::MAX_LOD];
+			float hysteresis;
+		};
+
+		const LodSettings defaultSettings = { { 12.0f, 24.0f, 40.0f }, 1.0f };
+
+		// Distance from the camera to the nearest point of the chunk column, in chunks
+		float chunkDistance(const glm::vec3& cameraPosition, int chunkX, int chunkZ);
+
+		// Level for a chunk at distance, currentLod is the level its mesh was built at (-1 for none)
+		int selectLod(const LodSettings& settings, float distance, int currentLod = -1);
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "core.h"
+#include "engine/blocks.h"
+
+namespace Engine {
+	namespace Mesher {
+		const int SECTION_SIZE = 16;
+		// Sections are meshed from a copy padded by one block on every side, so faces
+		// on the section border can be culled against the neighbouring sections
+		const int PADDED_SIZE = SECTION_SIZE + 2;
+		const int PADDED_VOLUME = PADDED_SIZE * PADDED_SIZE * PADDED_SIZE;
+
+		// x, y, z in [-1, SECTION_SIZE]
+		inline int paddedIndex(int x, int y, int z) {
+			return ((y + 1) * PADDED_SIZE + (z + 1)) * PADDED_SIZE + (x + 1);
+		}
+
+		// Bit (a * FACE_COUNT + b) is set when faces a and b of a section are joined by non-opaque blocks
+		typedef uint64_t FaceConnectivity;
+		const FaceConnectivity ALL_FACES_CONNECTED = (1ull << (FACE_COUNT * FACE_COUNT)) - 1;
+
+		inline bool facesConnected(FaceConnectivity connectivity, int a, int b) {
+			return (connectivity >> (a * FACE_COUNT + b)) & 1;
+		}
+
+		struct MeshData {
+			std::vector<PackedVertex> vertices;
+			std::vector<GLuint> indices;
+			// Filled by both meshers, used by the visibility graph
+			FaceConnectivity connectivity = ALL_FACES_CONNECTED;
+
+			void clear() { vertices.clear(); indices.clear(); connectivity = ALL_FACES_CONNECTED; }
+			size_t triangleCount() const { return indices.size() / 3; }
+		};
+
+		// Flood fills the non-opaque blocks of a section and records which faces each region touches
+		FaceConnectivity computeConnectivity(const BlockId* paddedBlocks);
+
+		// Levels of detail 1 to MAX_LOD mesh a section from 2 / 4 / 8 block cells
+		const int MAX_LOD = 3;
+		// LOD input is padded by one coarsest cell on every side, so the coarse cells past the border
+		// are built from the same blocks the neighbouring section builds its own border cells from
+		const int LOD_PADDING = 1 << MAX_LOD;
+		const int LOD_PADDED_SIZE = SECTION_SIZE + 2 * LOD_PADDING;
+		const int LOD_PADDED_VOLUME = LOD_PADDED_SIZE * LOD_PADDED_SIZE * LOD_PADDED_SIZE;
+
+		// x, y, z in [-LOD_PADDING, SECTION_SIZE + LOD_PADDING)
+		inline int lodPaddedIndex(int x, int y, int z) {
+			return ((y + LOD_PADDING) * LOD_PADDED_SIZE + (z + LOD_PADDING)) * LOD_PADDED_SIZE + (x + LOD_PADDING);
+		}
+
+		// Skirts hang from the surface edges on the x / z section border, closing the border faces the
+		// padding culled down to this many blocks, so a neighbour meshed at another level of detail
+		// (its surface up to a coarse cell lower) shows no crack. Both greedy meshers emit them
+		const int SKIRT_DEPTH = 1 << MAX_LOD;
+
+		// One quad per visible face
+		void meshNaive(const BlockId* paddedBlocks, MeshData& mesh);
+		// Visible faces merged into the largest rectangles of equal texture and ambient occlusion, plus skirts
+		void meshGreedy(const BlockId* paddedBlocks, MeshData& mesh);
+
+		// Reduces a section to (SECTION_SIZE >> lod) cells per side, stored with the paddedIndex layout
+		// (coordinates [-1, SECTION_SIZE >> lod]) so the mesher can read it directly
+		// Only the blocks within one cell (1 << lod) of the section are read
+		void downsample(const BlockId* lodPaddedBlocks, int lod, BlockId* coarseBlocks);
+		// Downsamples and greedy meshes a section, vertices are scaled back to block units, plus skirts
+		// Connectivity comes from the full resolution blocks, like meshGreedy
+		void meshGreedyLod(const BlockId* lodPaddedBlocks, int lod, MeshData& mesh);
+	}
+}
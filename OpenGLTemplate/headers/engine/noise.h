@@ -0,0 +1,24 @@
+#pragma once
+#include "core.h"
+#include "engine/cpu.h"
+
+namespace Engine {
+	namespace Noise {
+		// Every instruction set produces bit-identical output
+		typedef Cpu::Isa Isa;
+
+		struct FbmSettings {
+			int32_t seed;
+			int octaves;
+			float frequency;
+			float lacunarity;
+			float gain;
+		};
+
+		// Fractal simplex noise sampled on a grid with spacing step, roughly in [-1, 1]
+		// out[z * width + x] = fbm(originX + x * step, originZ + z * step)
+		void fbm2D(Isa isa, const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out);
+		// out[(y * depth + z) * width + x] = fbm(originX + x * step, originY + y * step, originZ + z * step)
+		void fbm3D(Isa isa, const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out);
+	}
+}
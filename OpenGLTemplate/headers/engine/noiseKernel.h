@@ -0,0 +1,292 @@
+#pragma once
+// Simplex noise kernels shared by noise.cpp, noiseSse.cpp and noiseAvx2.cpp, do not include elsewhere
+// The algorithm is written once against a lane type (Scalar, SSE 4-wide, AVX2 8-wide) so every
+// instruction set performs the same IEEE operations in the same order and returns identical bits.
+// Everything is in an anonymous namespace, each file compiles its own copy with its own target flags
+#include "engine/noise.h"
+
+#include <cmath>
+
+namespace Engine {
+	namespace Noise {
+		namespace {
+			struct ScalarLanes {
+				static const int WIDTH = 1;
+				typedef float F;
+				typedef uint32_t I;
+				typedef bool M;
+
+				static F set(float v) { return v; }
+				static I seti(uint32_t v) { return v; }
+				static F iota() { return 0.0f; }
+				static void store(float* p, F v) { *p = v; }
+
+				static F add(F a, F b) { return a + b; }
+				static F sub(F a, F b) { return a - b; }
+				static F mul(F a, F b) { return a * b; }
+				static F div(F a, F b) { return a / b; }
+				static F neg(F a) { return -a; }
+				static F floor(F a) { return std::floor(a); }
+				static I toInt(F a) { return (uint32_t)(int32_t)a; }
+				static F toFloat(I a) { return (float)(int32_t)a; }
+
+				static I addi(I a, I b) { return a + b; }
+				static I muli(I a, I b) { return a * b; }
+				static I xori(I a, I b) { return a ^ b; }
+				static I andi(I a, I b) { return a & b; }
+				template <int N> static I srli(I a) { return a >> N; }
+
+				static M gt(F a, F b) { return a > b; }
+				static M ge(F a, F b) { return a >= b; }
+				static M bitSet(I a, uint32_t bit) { return (a & bit) != 0; }
+				static M lessThan(I a, uint32_t v) { return a < v; }
+				static M equal(I a, uint32_t v) { return a == v; }
+				static M orM(M a, M b) { return a || b; }
+				static M andM(M a, M b) { return a && b; }
+				static F select(M m, F a, F b) { return m ? a : b; }
+			};
+
+			template <typename L>
+			inline typename L::I hash2(typename L::I i, typename L::I j, typename L::I seed) {
+				typename L::I h = L::xori(L::xori(L::muli(i, L::seti(0x27d4eb2du)), L::muli(j, L::seti(0x165667b1u))), seed);
+				h = L::xori(h, L::template srli<15>(h));
+				h = L::muli(h, L::seti(0x2c1b3c6du));
+				return L::xori(h, L::template srli<12>(h));
+			}
+
+			template <typename L>
+			inline typename L::I hash3(typename L::I i, typename L::I j, typename L::I k, typename L::I seed) {
+				return hash2<L>(L::xori(i, L::muli(k, L::seti(0x9e3779b1u))), j, seed);
+			}
+
+			// One of 8 unit-ish directions: 4 diagonals and 4 axes
+			template <typename L>
+			inline typename L::F gradDot2(typename L::I h, typename L::F x, typename L::F y) {
+				typename L::M axis = L::bitSet(h, 4);
+				typename L::M useY = L::bitSet(h, 2);
+				typename L::F gx = L::select(axis, L::select(useY, L::set(0.0f), x), x);
+				typename L::F gy = L::select(axis, L::select(useY, y, L::set(0.0f)), y);
+				gx = L::select(L::bitSet(h, 1), L::neg(gx), gx);
+				gy = L::select(L::bitSet(h, 8), L::neg(gy), gy);
+				return L::add(gx, gy);
+			}
+
+			// Perlin's 12 edge directions, 16 entries with four repeated
+			template <typename L>
+			inline typename L::F gradDot3(typename L::I h, typename L::F x, typename L::F y, typename L::F z) {
+				typename L::I h15 = L::andi(h, L::seti(15));
+				typename L::F u = L::select(L::lessThan(h15, 8), x, y);
+				typename L::F v = L::select(L::lessThan(h15, 4), y, L::select(L::orM(L::equal(h15, 12), L::equal(h15, 14)), x, z));
+				u = L::select(L::bitSet(h, 1), L::neg(u), u);
+				v = L::select(L::bitSet(h, 2), L::neg(v), v);
+				return L::add(u, v);
+			}
+
+			template <typename L>
+			inline typename L::F simplex2(typename L::F x, typename L::F y, typename L::I seed) {
+				typedef typename L::F F;
+				const F F2 = L::set(0.36602540378f);
+				const F G2 = L::set(0.21132486540f);
+				const F one = L::set(1.0f);
+				const F zero = L::set(0.0f);
+
+				F s = L::mul(L::add(x, y), F2);
+				F i = L::floor(L::add(x, s));
+				F j = L::floor(L::add(y, s));
+				F t = L::mul(L::add(i, j), G2);
+				F x0 = L::sub(x, L::sub(i, t));
+				F y0 = L::sub(y, L::sub(j, t));
+
+				typename L::M lower = L::gt(x0, y0);
+				F i1 = L::select(lower, one, zero);
+				F j1 = L::select(lower, zero, one);
+				F x1 = L::add(L::sub(x0, i1), G2);
+				F y1 = L::add(L::sub(y0, j1), G2);
+				F x2 = L::add(L::sub(x0, one), L::add(G2, G2));
+				F y2 = L::add(L::sub(y0, one), L::add(G2, G2));
+
+				typename L::I ii = L::toInt(i);
+				typename L::I jj = L::toInt(j);
+				typename L::I h0 = hash2<L>(ii, jj, seed);
+				typename L::I h1 = hash2<L>(L::addi(ii, L::toInt(i1)), L::addi(jj, L::toInt(j1)), seed);
+				typename L::I h2 = hash2<L>(L::addi(ii, L::seti(1)), L::addi(jj, L::seti(1)), seed);
+
+				const F half = L::set(0.5f);
+				F t0 = L::sub(L::sub(half, L::mul(x0, x0)), L::mul(y0, y0));
+				F t1 = L::sub(L::sub(half, L::mul(x1, x1)), L::mul(y1, y1));
+				F t2 = L::sub(L::sub(half, L::mul(x2, x2)), L::mul(y2, y2));
+				t0 = L::select(L::gt(t0, zero), t0, zero);
+				t1 = L::select(L::gt(t1, zero), t1, zero);
+				t2 = L::select(L::gt(t2, zero), t2, zero);
+				t0 = L::mul(t0, t0);
+				t1 = L::mul(t1, t1);
+				t2 = L::mul(t2, t2);
+
+				F n0 = L::mul(L::mul(t0, t0), gradDot2<L>(h0, x0, y0));
+				F n1 = L::mul(L::mul(t1, t1), gradDot2<L>(h1, x1, y1));
+				F n2 = L::mul(L::mul(t2, t2), gradDot2<L>(h2, x2, y2));
+				return L::mul(L::set(45.0f), L::add(L::add(n0, n1), n2));
+			}
+
+			template <typename L>
+			inline typename L::F simplex3(typename L::F x, typename L::F y, typename L::F z, typename L::I seed) {
+				typedef typename L::F F;
+				typedef typename L::M M;
+				const F F3 = L::set(1.0f / 3.0f);
+				const F G3 = L::set(1.0f / 6.0f);
+				const F one = L::set(1.0f);
+				const F zero = L::set(0.0f);
+
+				F s = L::mul(L::add(L::add(x, y), z), F3);
+				F i = L::floor(L::add(x, s));
+				F j = L::floor(L::add(y, s));
+				F k = L::floor(L::add(z, s));
+				F t = L::mul(L::add(L::add(i, j), k), G3);
+				F x0 = L::sub(x, L::sub(i, t));
+				F y0 = L::sub(y, L::sub(j, t));
+				F z0 = L::sub(z, L::sub(k, t));
+
+				// Pick the simplex corners without branching
+				M xGeY = L::ge(x0, y0);
+				M xGeZ = L::ge(x0, z0);
+				M yGeZ = L::ge(y0, z0);
+				M yGtX = L::gt(y0, x0);
+				M zGtX = L::gt(z0, x0);
+				M zGtY = L::gt(z0, y0);
+				F i1 = L::select(L::andM(xGeY, xGeZ), one, zero);
+				F j1 = L::select(L::andM(yGtX, yGeZ), one, zero);
+				F k1 = L::select(L::andM(zGtX, zGtY), one, zero);
+				F i2 = L::select(L::orM(xGeY, xGeZ), one, zero);
+				F j2 = L::select(L::orM(yGtX, yGeZ), one, zero);
+				F k2 = L::select(L::orM(zGtX, zGtY), one, zero);
+
+				const F G3x2 = L::add(G3, G3);
+				const F G3x3 = L::add(G3x2, G3);
+				F x1 = L::add(L::sub(x0, i1), G3);
+				F y1 = L::add(L::sub(y0, j1), G3);
+				F z1 = L::add(L::sub(z0, k1), G3);
+				F x2 = L::add(L::sub(x0, i2), G3x2);
+				F y2 = L::add(L::sub(y0, j2), G3x2);
+				F z2 = L::add(L::sub(z0, k2), G3x2);
+				F x3 = L::add(L::sub(x0, one), G3x3);
+				F y3 = L::add(L::sub(y0, one), G3x3);
+				F z3 = L::add(L::sub(z0, one), G3x3);
+
+				typename L::I ii = L::toInt(i);
+				typename L::I jj = L::toInt(j);
+				typename L::I kk = L::toInt(k);
+				typename L::I h0 = hash3<L>(ii, jj, kk, seed);
+				typename L::I h1 = hash3<L>(L::addi(ii, L::toInt(i1)), L::addi(jj, L::toInt(j1)), L::addi(kk, L::toInt(k1)), seed);
+				typename L::I h2 = hash3<L>(L::addi(ii, L::toInt(i2)), L::addi(jj, L::toInt(j2)), L::addi(kk, L::toInt(k2)), seed);
+				typename L::I h3 = hash3<L>(L::addi(ii, L::seti(1)), L::addi(jj, L::seti(1)), L::addi(kk, L::seti(1)), seed);
+
+				const F radius = L::set(0.6f);
+				F t0 = L::sub(L::sub(L::sub(radius, L::mul(x0, x0)), L::mul(y0, y0)), L::mul(z0, z0));
+				F t1 = L::sub(L::sub(L::sub(radius, L::mul(x1, x1)), L::mul(y1, y1)), L::mul(z1, z1));
+				F t2 = L::sub(L::sub(L::sub(radius, L::mul(x2, x2)), L::mul(y2, y2)), L::mul(z2, z2));
+				F t3 = L::sub(L::sub(L::sub(radius, L::mul(x3, x3)), L::mul(y3, y3)), L::mul(z3, z3));
+				t0 = L::select(L::gt(t0, zero), t0, zero);
+				t1 = L::select(L::gt(t1, zero), t1, zero);
+				t2 = L::select(L::gt(t2, zero), t2, zero);
+				t3 = L::select(L::gt(t3, zero), t3, zero);
+				t0 = L::mul(t0, t0);
+				t1 = L::mul(t1, t1);
+				t2 = L::mul(t2, t2);
+				t3 = L::mul(t3, t3);
+
+				F n0 = L::mul(L::mul(t0, t0), gradDot3<L>(h0, x0, y0, z0));
+				F n1 = L::mul(L::mul(t1, t1), gradDot3<L>(h1, x1, y1, z1));
+				F n2 = L::mul(L::mul(t2, t2), gradDot3<L>(h2, x2, y2, z2));
+				F n3 = L::mul(L::mul(t3, t3), gradDot3<L>(h3, x3, y3, z3));
+				return L::mul(L::set(32.0f), L::add(L::add(L::add(n0, n1), n2), n3));
+			}
+
+			inline uint32_t octaveSeed(const FbmSettings& settings, int octave) {
+				return (uint32_t)settings.seed + (uint32_t)octave * 0x9e3779b9u;
+			}
+
+			template <typename L>
+			inline typename L::F fbmPoint2(const FbmSettings& settings, typename L::F x, typename L::F z) {
+				typename L::F sum = L::set(0.0f);
+				float amplitude = 1.0f;
+				float frequency = settings.frequency;
+				float total = 0.0f;
+				for (int octave = 0; octave < settings.octaves; octave++) {
+					typename L::F noise = simplex2<L>(L::mul(x, L::set(frequency)), L::mul(z, L::set(frequency)), L::seti(octaveSeed(settings, octave)));
+					sum = L::add(sum, L::mul(L::set(amplitude), noise));
+					total += amplitude;
+					amplitude *= settings.gain;
+					frequency *= settings.lacunarity;
+				}
+				return L::div(sum, L::set(total));
+			}
+
+			template <typename L>
+			inline typename L::F fbmPoint3(const FbmSettings& settings, typename L::F x, typename L::F y, typename L::F z) {
+				typename L::F sum = L::set(0.0f);
+				float amplitude = 1.0f;
+				float frequency = settings.frequency;
+				float total = 0.0f;
+				for (int octave = 0; octave < settings.octaves; octave++) {
+					typename L::F f = L::set(frequency);
+					typename L::F noise = simplex3<L>(L::mul(x, f), L::mul(y, f), L::mul(z, f), L::seti(octaveSeed(settings, octave)));
+					sum = L::add(sum, L::mul(L::set(amplitude), noise));
+					total += amplitude;
+					amplitude *= settings.gain;
+					frequency *= settings.lacunarity;
+				}
+				return L::div(sum, L::set(total));
+			}
+
+			// Grid coordinate of column x, computed the same way for every lane width
+			template <typename L>
+			inline typename L::F gridCoordinate(float origin, float step, int x) {
+				return L::add(L::set(origin), L::mul(L::add(L::iota(), L::set((float)x)), L::set(step)));
+			}
+
+			// Full vectors of L, the remainder of each row one column at a time
+			template <typename L>
+			void fbm2DGrid(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out) {
+				for (int z = 0; z < depth; z++) {
+					const float pz = originZ + (float)z * step;
+					float* row = out + (size_t)z * width;
+					int x = 0;
+					for (; x + L::WIDTH <= width; x += L::WIDTH) {
+						L::store(row + x, fbmPoint2<L>(settings, gridCoordinate<L>(originX, step, x), L::set(pz)));
+					}
+					for (; x < width; x++) {
+						ScalarLanes::store(row + x, fbmPoint2<ScalarLanes>(settings, gridCoordinate<ScalarLanes>(originX, step, x), pz));
+					}
+				}
+			}
+
+			template <typename L>
+			void fbm3DGrid(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out) {
+				for (int y = 0; y < height; y++) {
+					const float py = originY + (float)y * step;
+					for (int z = 0; z < depth; z++) {
+						const float pz = originZ + (float)z * step;
+						float* row = out + ((size_t)y * depth + z) * width;
+						int x = 0;
+						for (; x + L::WIDTH <= width; x += L::WIDTH) {
+							L::store(row + x, fbmPoint3<L>(settings, gridCoordinate<L>(originX, step, x), L::set(py), L::set(pz)));
+						}
+						for (; x < width; x++) {
+							ScalarLanes::store(row + x, fbmPoint3<ScalarLanes>(settings, gridCoordinate<ScalarLanes>(originX, step, x), py, pz));
+						}
+					}
+				}
+			}
+		}
+
+		// Per instruction set entry points, defined in noise.cpp / noiseSse.cpp / noiseAvx2.cpp
+		namespace Detail {
+			void fbm2DScalar(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out);
+			void fbm3DScalar(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out);
+			void fbm2DSse41(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out);
+			void fbm3DSse41(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out);
+			void fbm2DAvx2(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out);
+			void fbm3DAvx2(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out);
+		}
+	}
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "core.h"
+#include "engine/renderState.h"
+
+#include <atomic>
+
+// Scope macros, names must be string literals (only the pointer is stored)
+// Built without ENGINE_PROFILE they expand to nothing, built with it a disabled profiler costs one branch
+#ifdef ENGINE_PROFILE
+#define ENGINE_PROFILE_CONCAT_INNER(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ::Engine::Profiler::CpuScope ENGINE_PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#define PROFILE_GPU_SCOPE(name) ::Engine::Profiler::GpuScope ENGINE_PROFILE_CONCAT(profileGpuScope, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_GPU_SCOPE(name) ((void)0)
+#endif
+
+namespace Engine {
+	// Hierarchical frame profiler
+	//   CPU scopes: any thread, recorded into a per-thread buffer, collected at endFrame
+	//   GPU scopes: GL thread, a GL_TIMESTAMP query pair each, read back frames later once
+	//   available so the CPU never waits on the GPU. Results older than MAX_GPU_FRAMES_IN_FLIGHT
+	//   frames are dropped instead
+	// Every frame is aggregated per scope name into a FrameReport, the last HISTORY_FRAMES frames
+	// of raw events are kept for writeChromeTrace (chrome://tracing, Perfetto)
+	namespace Profiler {
+		static constexpr int MAX_GPU_FRAMES_IN_FLIGHT = 6;
+		static constexpr int HISTORY_FRAMES = 240;
+
+		struct ScopeStats {
+			const char* name;
+			uint32_t depth;		// Of the first occurrence
+			uint32_t calls;
+			double startMs;		// First occurrence, from the start of the frame
+			double totalMs;
+		};
+
+		struct FrameReport {
+			uint64_t frame;
+			double frameMs;
+			std::vector<ScopeStats> cpuScopes;		// Sorted by startMs
+			uint64_t gpuFrame;						// GPU results lag behind, frame they belong to
+			std::vector<ScopeStats> gpuScopes;
+			double gpuFrameMs;						// First GPU scope start to last end
+			RenderState::Counters stateCalls;
+			uint32_t droppedGpuFrames;				// Total so far
+		};
+
+		// GPU scopes need a current context when enabling. shutdown() frees the queries
+		void setEnabled(bool enabled);
+		bool isEnabled();
+		void shutdown();
+
+		// Bracket every frame on the GL thread, endFrame aggregates and reads back finished GPU queries
+		void beginFrame();
+		void endFrame();
+		const FrameReport& lastReport();
+		// One line per scope of lastReport()
+		void printReport();
+
+		// Kept frames as Chrome trace event JSON, returns false on I/O errors
+		bool writeChromeTrace(const std::string& path);
+
+		void beginCpuScope(const char* name);
+		void endCpuScope();
+		void beginGpuScope(const char* name);
+		void endGpuScope();
+
+		namespace Detail {
+			extern std::atomic<bool> enabled;
+		}
+
+		class CpuScope {
+		private:
+			bool active;
+
+		public:
+			explicit CpuScope(const char* name) : active(Detail::enabled.load(std::memory_order_relaxed)) {
+				if (active) beginCpuScope(name);
+			}
+			~CpuScope() {
+				if (active) endCpuScope();
+			}
+			CpuScope(const CpuScope&) = delete;
+			CpuScope& operator=(const CpuScope&) = delete;
+		};
+
+		class GpuScope {
+		private:
+			bool active;
+
+		public:
+			explicit GpuScope(const char* name) : active(Detail::enabled.load(std::memory_order_relaxed)) {
+				if (active) beginGpuScope(name);
+			}
+			~GpuScope() {
+				if (active) endGpuScope();
+			}
+			GpuScope(const GpuScope&) = delete;
+			GpuScope& operator=(const GpuScope&) = delete;
+		};
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "core.h"
+
+#include <initializer_list>
+
+namespace Engine {
+	// On-disk cache of linked program binaries, so startup skips GLSL compilation after the first run
+	//   file <directory>/<key as 16 hex digits>.bin: u32 magic, u32 binary format, u32 length, binary
+	// Keys hash the shader sources together with the GL vendor, renderer and version strings, so a
+	// driver update never loads a stale binary. A binary the driver still rejects is deleted, and the
+	// caller falls back to compiling. Needs a current context, all methods are for the GL thread only
+	class ProgramCache {
+	private:
+		std::string directory;
+		std::string driverId;
+		bool supported;
+		size_t hits = 0;
+		size_t misses = 0;
+
+		std::string pathOf(uint64_t key) const;
+
+	public:
+		// Creates the directory if missing, when that fails the cache runs as unsupported
+		ProgramCache(const std::string& directory);
+
+		// False when the driver exposes no binary formats or the directory is unusable, load then
+		// always misses and store is a no-op
+		bool isSupported() const { return supported; }
+		uint64_t makeKey(std::initializer_list<std::string> sources) const;
+
+		// Returns a linked program, or 0 when missing or rejected by the driver
+		GLuint load(uint64_t key);
+		// program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+		void store(uint64_t key, GLuint program);
+
+		size_t getHits() const { return hits; }
+		size_t getMisses() const { return misses; }
+	};
+}
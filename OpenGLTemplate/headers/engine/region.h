@@ -0,0 +1,71 @@
+#pragma once
+#include "core.h"
+#include "engine/chunk.h"
+
+#include <memory>
+#include <mutex>
+
+namespace Engine {
+	// 32x32 chunk columns in one file:
+	//   sector 0: 1024 u32 locations, (first sector << 8) | sector count, 0 = not stored
+	//   chunk:    u32 payload size, u8 compression, payload, padded to whole 4 KiB sectors
+	// Reads go through a read-only memory map of the file. A save writes the chunk to the first free
+	// run (never its current sectors) or appends it, then rewrites just its 4 byte location and only
+	// then frees the old sectors: a crash mid-save leaves the previous copy intact and referenced
+	class RegionFile {
+	public:
+		static constexpr int REGION_SIZE = 32;
+		static constexpr int SECTOR_SIZE = 4096;
+		static constexpr int MAX_CHUNK_SECTORS = 255;
+
+	private:
+		std::string path;
+		intptr_t fileHandle;
+		intptr_t mappingHandle;
+		const uint8_t* mapped;
+		size_t mappedSize;
+		size_t fileSize;
+		uint32_t locations[REGION_SIZE * REGION_SIZE];
+		std::vector<bool> usedSectors;
+		std::vector<uint8_t> scratch;
+		mutable std::mutex mutex;
+
+		void remap();
+		void unmap();
+		void writeAt(size_t offset, const void* data, size_t size);
+		uint32_t allocateSectors(uint32_t sectorCount);
+
+	public:
+		// Opens or creates the file, throws std::runtime_error on I/O failure
+		RegionFile(const std::string& path);
+		~RegionFile();
+		RegionFile(const RegionFile&) = delete;
+		RegionFile& operator=(const RegionFile&) = delete;
+
+		bool hasChunk(int localX, int localZ) const;
+		// False when the chunk was never saved, throws if the stored data is corrupt
+		bool load(int localX, int localZ, Chunk& chunk);
+		void save(int localX, int localZ, const Chunk& chunk);
+
+		size_t getFileSize() const { return fileSize; }
+		const std::string& getPath() const { return path; }
+	};
+
+	// Chunk columns of a whole world, region files are opened on first use and kept open
+	class RegionStorage {
+	private:
+		std::string directory;
+		std::unordered_map<uint64_t, std::unique_ptr<RegionFile>> regions;
+		mutable std::mutex mutex;
+
+		RegionFile& getRegion(int chunkX, int chunkZ);
+
+	public:
+		RegionStorage(const std::string& directory);
+
+		bool load(int chunkX, int chunkZ, Chunk& chunk);
+		void save(int chunkX, int chunkZ, const Chunk& chunk);
+		size_t regionCount() const;
+		size_t totalFileSize() const;
+	};
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	// Shadow copy of the bind points and fixed-function state the engine touches, so a bind of
+	// what is already bound never reaches the driver. All state changes made by engine code go
+	// through here, a raw gl call to any of these leaves the shadow stale until invalidate()
+	// GL thread only, one context
+	namespace RenderState {
+		// Per-frame count of state calls, issued reached GL, elided were redundant and skipped
+		struct Counters {
+			uint32_t issued;
+			uint32_t elided;
+		};
+
+		// Bind points tracked by bindBuffer / bindBufferBase
+		static constexpr int MAX_BUFFER_BASES = 16;
+		static constexpr int MAX_TEXTURE_UNITS = 32;
+
+		void useProgram(GLuint program);
+		void bindVertexArray(GLuint vao);
+		// Non-VAO targets only: GL_ARRAY_BUFFER, GL_DRAW_INDIRECT_BUFFER, GL_DISPATCH_INDIRECT_BUFFER,
+		// GL_PARAMETER_BUFFER, GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, GL_PIXEL_PACK_BUFFER,
+		// GL_PIXEL_UNPACK_BUFFER. The element buffer belongs to the VAO, set it with glVertexArrayElementBuffer
+		void bindBuffer(GLenum target, GLuint buffer);
+		// GL_UNIFORM_BUFFER and GL_SHADER_STORAGE_BUFFER, index < MAX_BUFFER_BASES, whole-buffer bindings
+		void bindBufferBase(GLenum target, GLuint index, GLuint buffer);
+		void bindTextureUnit(GLuint unit, GLuint texture);
+		void bindFramebuffer(GLuint framebuffer);
+
+		// GL_BLEND, GL_DEPTH_TEST, GL_CULL_FACE, GL_SCISSOR_TEST, GL_STENCIL_TEST,
+		// GL_POLYGON_OFFSET_FILL, GL_FRAMEBUFFER_SRGB, GL_PRIMITIVE_RESTART
+		void setEnabled(GLenum capability, bool enabled);
+		void blendFunc(GLenum source, GLenum destination);
+		void depthFunc(GLenum func);
+		void depthMask(bool write);
+		void cullFace(GLenum face);
+
+		// GL unbinds a deleted object from the current bind points and later reuses its name,
+		// call these after deleting one so a new object with the same name is bound again
+		void forgetProgram(GLuint program);
+		void forgetVertexArray(GLuint vao);
+		void forgetBuffer(GLuint buffer);
+		void forgetTexture(GLuint texture);
+		void forgetFramebuffer(GLuint framebuffer);
+
+		// Marks every shadow value unknown, for a new context or after raw gl state calls
+		void invalidate();
+
+		const Counters& getCounters();
+		// Call once at the start of every frame
+		void resetCounters();
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include "core.h"
+#include "engine/buffers.h"
+#include "engine/allocator.h"
+#include "engine/texture.h"
+
+namespace Engine {
+	// Matches the layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+	struct DrawElementsIndirectCommand {
+		GLuint count;
+		GLuint instanceCount;
+		GLuint firstIndex;
+		GLint baseVertex;
+		GLuint baseInstance;
+	};
+
+	struct RendererStats {
+		unsigned int meshesDrawn;
+		unsigned int multiDrawCalls;
+		unsigned int trianglesDrawn;
+		unsigned int drawsDropped;	// addDraw calls past maxDrawsPerFrame, their geometry is missing this frame
+	};
+
+	// Batched chunk renderer, all meshes live in shared arenas and every visible mesh
+	// of a pass is submitted with one glMultiDrawElementsIndirect per arena page
+	class ChunkRenderer {
+	public:
+		typedef uint32_t MeshId;
+		static constexpr MeshId InvalidMesh = 0;
+
+	private:
+		struct Mesh {
+			Buffers::BufferArena::Handle vertices;
+			Buffers::BufferArena::Handle indices;
+			GLuint indexCount;
+			bool live;
+		};
+		struct DrawRecord {
+			GLuint vertexBufferId;
+			GLuint indexBufferId;
+			MeshId mesh;
+			glm::vec3 chunkOrigin;
+		};
+
+		GLuint vaoID;
+		Buffers::BufferArena vertexArena;
+		Buffers::BufferArena indexArena;
+		Buffers::StreamBuffer streamBuffer;
+		std::vector<Mesh> meshes;
+		std::vector<MeshId> freeMeshes;
+		std::vector<DrawRecord> drawList;
+		std::vector<DrawElementsIndirectCommand> commands;
+		std::vector<glm::vec3> origins;
+		RendererStats frameStats;
+		int maxDrawsPerFrame;
+		const TextureArray* blockTextures;
+
+	public:
+		ChunkRenderer(GLsizeiptr pageSize = 64 * 1024 * 1024, int maxDrawsPerFrame = 65536);
+		~ChunkRenderer();
+		ChunkRenderer(const ChunkRenderer&) = delete;
+		ChunkRenderer& operator=(const ChunkRenderer&) = delete;
+
+		// Indices are local to the mesh, baseVertex is applied at draw time
+		MeshId uploadMesh(const PackedVertex* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount);
+		void removeMesh(MeshId mesh);
+
+		// Collect visible meshes, then submit them in one pass
+		void beginFrame();
+		// Invalid or removed meshes are ignored, draws past maxDrawsPerFrame are counted in drawsDropped
+		void addDraw(MeshId mesh, const glm::vec3& chunkOrigin);
+		void draw();
+
+		// Bound to BLOCK_TEXTURE_UNIT once per draw(), every chunk samples its layers from it
+		void setBlockTextures(const TextureArray* textures) { blockTextures = textures; }
+
+		const RendererStats& stats() const { return frameStats; }
+		Buffers::BufferArena& getVertexArena() { return vertexArena; }
+		Buffers::BufferArena& getIndexArena() { return indexArena; }
+	};
+}
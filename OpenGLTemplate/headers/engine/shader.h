@@ -2,14 +2,97 @@
 #include "core.h"
 
 namespace Engine {
+	class ProgramCache;
+	class ShaderManager;
+
+	// A uniform location resolved once, the type parameter stops setting a mat4 uniform with a float
+	// Set through Shader::set, which uses glProgramUniform* and leaves the bound program alone
+	template <typename T>
+	struct UniformHandle {
+		GLuint programId = 0;
+		GLint location = -1;	// -1 (not active) makes every set a no-op, like glUniform*
+
+		bool isValid() const { return location >= 0; }
+	};
+
 	class Shader {
 	private:
+		friend class ShaderManager;
+
+		struct UniformInfo {
+			GLint location;
+			GLenum type;
+		};
+
 		GLuint shaderId;
-		std::unordered_map<std::string, int> uniformLocations;
+		std::unordered_map<std::string, UniformInfo> uniforms;
+
+		// Compilation is split so ShaderManager can issue many programs before waiting on any
+		struct PendingProgram {
+			GLuint programId = 0;
+			GLuint vertexShaderId = 0;
+			GLuint fragmentShaderId = 0;
+		};
+
+		static std::string readSource(const std::string& path);
+		static GLuint compileProgram(const std::string& vertexCode, const std::string& fragmentCode, bool retrievable);
+		static PendingProgram beginProgram(const std::string& vertexCode, const std::string& fragmentCode, bool retrievable);
+		static GLuint finishProgram(const PendingProgram& pending);
+		static void deletePending(const PendingProgram& pending);
+		void introspect();
+		const UniformInfo* findUniform(const std::string& name) const;
+		static bool typeMatches(GLenum type, const bool*) { return type == GL_BOOL; }
+		static bool isOpaqueType(GLenum type);
+		static bool typeMatches(GLenum type, const int*) { return type == GL_INT || isOpaqueType(type); }
+		static bool typeMatches(GLenum type, const unsigned int*) { return type == GL_UNSIGNED_INT; }
+		static bool typeMatches(GLenum type, const float*) { return type == GL_FLOAT; }
+		static bool typeMatches(GLenum type, const glm::vec2*) { return type == GL_FLOAT_VEC2; }
+		static bool typeMatches(GLenum type, const glm::vec3*) { return type == GL_FLOAT_VEC3; }
+		static bool typeMatches(GLenum type, const glm::vec4*) { return type == GL_FLOAT_VEC4; }
+		static bool typeMatches(GLenum type, const glm::mat3*) { return type == GL_FLOAT_MAT3; }
+		static bool typeMatches(GLenum type, const glm::mat4*) { return type == GL_FLOAT_MAT4; }
+
+		// A mismatch either throws (explicit handles) or gives an invalid handle (by-name setters)
+		template <typename T>
+		UniformHandle<T> resolveUniform(const std::string& name, bool throwOnMismatch) const {
+			UniformHandle<T> handle;
+			handle.programId = shaderId;
+			const UniformInfo* info = findUniform(name);
+			if (info == nullptr) return handle;
+			if (!typeMatches(info->type, (const T*)nullptr)) {
+				if (throwOnMismatch) throw std::runtime_error("ERROR::SHADER::UNIFORM_TYPE_MISMATCH " + name);
+				return handle;
+			}
+			handle.location = info->location;
+			return handle;
+		}
 
 	public:
-		Shader(const std::string& vertexPath, const std::string& fragmentPath);
+		// With a cache the linked program is loaded from / saved to disk, compiling only on a miss
+		Shader(const std::string& vertexPath, const std::string& fragmentPath, ProgramCache* cache = nullptr);
+		// Adopts an already linked program
+		explicit Shader(GLuint linkedProgram);
 		void use();
+		GLuint id() const { return shaderId; }
+
+		// Resolve once (after construction), then set through the handle every frame
+		// Unknown names give an invalid handle, a type mismatch throws std::runtime_error
+		template <typename T>
+		UniformHandle<T> getUniform(const std::string& name) const {
+			return resolveUniform<T>(name, true);
+		}
+
+		static void set(UniformHandle<bool> handle, bool value) { glProgramUniform1i(handle.programId, handle.location, (int)value); }
+		static void set(UniformHandle<int> handle, int value) { glProgramUniform1i(handle.programId, handle.location, value); }
+		static void set(UniformHandle<unsigned int> handle, unsigned int value) { glProgramUniform1ui(handle.programId, handle.location, value); }
+		static void set(UniformHandle<float> handle, float value) { glProgramUniform1f(handle.programId, handle.location, value); }
+		static void set(UniformHandle<glm::vec2> handle, const glm::vec2& vec) { glProgramUniform2f(handle.programId, handle.location, vec.x, vec.y); }
+		static void set(UniformHandle<glm::vec3> handle, const glm::vec3& vec) { glProgramUniform3f(handle.programId, handle.location, vec.x, vec.y, vec.z); }
+		static void set(UniformHandle<glm::vec4> handle, const glm::vec4& vec) { glProgramUniform4f(handle.programId, handle.location, vec.x, vec.y, vec.z, vec.w); }
+		static void set(UniformHandle<glm::mat3> handle, const glm::mat3& mat) { glProgramUniformMatrix3fv(handle.programId, handle.location, 1, GL_FALSE, glm::value_ptr(mat)); }
+		static void set(UniformHandle<glm::mat4> handle, const glm::mat4& mat) { glProgramUniformMatrix4fv(handle.programId, handle.location, 1, GL_FALSE, glm::value_ptr(mat)); }
+
+		// By-name setters, a hash lookup per call, prefer handles for anything set every frame
 		void setBool(const std::string& name, const bool value);
 		void setInt(const std::string& name, const int value);
 		void setFloat(const std::string& name, const float value);
@@ -20,5 +103,3 @@ namespace Engine {
 		void setVec4(const std::string& name, const glm::vec4 vec);
 	};
 }
-
-
@@ -0,0 +1,50 @@
+#pragma once
+#include "core.h"
+#include "engine/shader.h"
+
+#include <memory>
+
+namespace Engine {
+	class ProgramCache;
+
+	// Starts compiling every program up front and waits on one only when it is first needed, so the
+	// driver compiles while the caller loads assets and generates the world. With
+	// KHR_parallel_shader_compile the driver compiles on its own threads and isReady polls
+	// GL_COMPLETION_STATUS_KHR without blocking; otherwise the work is deferred to get (or done at
+	// submit by drivers that compile eagerly). Programs found in the cache skip compilation entirely
+	class ShaderManager {
+	private:
+		struct Entry {
+			Shader::PendingProgram pending;
+			bool fromCache = false;
+			uint64_t cacheKey = 0;
+			std::unique_ptr<Shader> shader;		// Set once finished
+		};
+
+		ProgramCache* cache;
+		bool parallelCompile;
+		std::unordered_map<std::string, Entry> entries;
+
+		Entry& find(const std::string& name);
+		Shader& finish(const std::string& name, Entry& entry);
+
+	public:
+		ShaderManager(ProgramCache* cache = nullptr);
+		// Deletes every program, finished or not
+		~ShaderManager();
+		ShaderManager(const ShaderManager&) = delete;
+		ShaderManager& operator=(const ShaderManager&) = delete;
+
+		// Reads both files and issues compile + link, throws std::runtime_error on read errors or a reused name
+		void submit(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath);
+		// Never blocks. Without the extension this is always true and get may block
+		bool isReady(const std::string& name);
+		// Blocks until the program is linked on first use, then throws its compile / link error like Shader does
+		Shader& get(const std::string& name);
+		// Waits for every submitted program, throws the first error
+		void finishAll();
+
+		bool isParallel() const { return parallelCompile; }
+		size_t pendingCount() const;
+	};
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include "core.h"
+
+#include <atomic>
+
+namespace Engine {
+	// Bounded lock-free queue for exactly one producer thread and one consumer thread
+	// Capacity is rounded up to a power of two. Head and tail live on separate cache lines, each
+	// side keeps a cached copy of the other's index so it only touches the shared line when the
+	// cache says the queue is full / empty
+	template <typename T>
+	class SpscQueue {
+	private:
+		static constexpr size_t CACHE_LINE = 64;
+
+		std::vector<T> slots;
+		size_t mask;
+		alignas(CACHE_LINE) std::atomic<size_t> head;		// Next slot to read, written by the consumer
+		size_t cachedTail;									// Consumer's view of tail
+		alignas(CACHE_LINE) std::atomic<size_t> tail;		// Next slot to write, written by the producer
+		size_t cachedHead;									// Producer's view of head
+		std::atomic<uint64_t> droppedCount;
+
+		static size_t roundUp(size_t capacity) {
+			size_t size = 2;
+			while (size < capacity) size *= 2;
+			return size;
+		}
+
+	public:
+		explicit SpscQueue(size_t capacity)
+			: slots(roundUp(capacity)), mask(roundUp(capacity) - 1), head(0), cachedTail(0), tail(0), cachedHead(0), droppedCount(0) {}
+		SpscQueue(const SpscQueue&) = delete;
+		SpscQueue& operator=(const SpscQueue&) = delete;
+
+		// Producer only, returns false (and counts a drop) when full
+		bool push(const T& value) {
+			const size_t writeIndex = tail.load(std::memory_order_relaxed);
+			if (writeIndex - cachedHead > mask) {
+				cachedHead = head.load(std::memory_order_acquire);
+				if (writeIndex - cachedHead > mask) {
+					droppedCount.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+			}
+			slots[writeIndex & mask] = value;
+			tail.store(writeIndex + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only, the oldest element or nullptr when empty, valid until pop()
+		const T* peek() {
+			const size_t readIndex = head.load(std::memory_order_relaxed);
+			if (readIndex == cachedTail) {
+				cachedTail = tail.load(std::memory_order_acquire);
+				if (readIndex == cachedTail) return nullptr;
+			}
+			return &slots[readIndex & mask];
+		}
+
+		// Consumer only, removes the element returned by peek()
+		void pop() {
+			head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+		}
+
+		// Consumer only, returns false when empty
+		bool pop(T& value) {
+			const T* front = peek();
+			if (front == nullptr) return false;
+			value = *front;
+			pop();
+			return true;
+		}
+
+		size_t capacity() const { return mask + 1; }
+		// Approximate when called while the other side is running
+		size_t size() const { return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire); }
+		uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+	};
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "core.h"
+#include "engine/chunk.h"
+#include "engine/culling.h"
+#include "engine/lod.h"
+#include "engine/region.h"
+#include "engine/renderer.h"
+#include "engine/terrain.h"
+
+#include <memory>
+
+namespace Engine {
+	struct StreamingSettings {
+		int renderDistance;		// Chunks meshed and drawn, data is kept one chunk further for their neighbours
+		int sectionCount;
+		int maxJobsPerFrame;	// Load / generate / mesh jobs started per update
+		int maxJobsInFlight;	// Kept low so work is still started in priority order after the camera moves
+		int maxUploadsPerFrame;	// Chunk meshes copied to the GPU per update
+		float viewBias;			// Chunks straight ahead are treated as this many chunks closer than those behind
+		Lod::LodSettings lod;
+	};
+
+	const StreamingSettings defaultStreamingSettings = { 12, 16, 16, 32, 16, 4.0f, Lod::defaultSettings };
+
+	// Running totals since construction
+	struct StreamingStats {
+		size_t generated;
+		size_t loadedFromDisk;
+		size_t meshed;
+		size_t uploaded;
+		size_t cancelled;	// Jobs dropped because their chunk went out of range first
+		size_t unloaded;
+	};
+
+	// Keeps the chunks around the camera loaded, meshed and uploaded. Each update finishes the
+	// jobs that are done, unloads what is out of range (cancelling its jobs), then starts the
+	// most urgent missing work (nearest first, ahead of the camera before behind) within budget
+	class ChunkStreamer {
+	private:
+		struct Task;
+		struct Column;
+
+		const TerrainGenerator& generator;
+		ChunkRenderer& renderer;
+		RegionStorage* storage;
+		StreamingSettings settings;
+		std::unordered_map<uint64_t, std::unique_ptr<Column>> columns;
+		std::vector<std::shared_ptr<Task>> tasksInFlight;
+		glm::ivec2 cameraChunk;
+		StreamingStats totals;
+
+		Column* findColumn(int chunkX, int chunkZ) const;
+		bool neighboursLoaded(int chunkX, int chunkZ) const;
+		void finishTasks();
+		void unloadDistantColumns(const glm::vec3& cameraPosition);
+		void uploadMeshes();
+		void startJobs(const glm::vec3& cameraPosition, const glm::vec3& forward);
+		void startLoad(int chunkX, int chunkZ);
+		void startMesh(Column& column, int lod);
+
+	public:
+		// storage is optional, chunks found there are loaded instead of generated and
+		// newly generated chunks are written to it
+		ChunkStreamer(const TerrainGenerator& generator, ChunkRenderer& renderer, RegionStorage* storage = nullptr,
+			const StreamingSettings& settings = defaultStreamingSettings);
+		// Cancels everything and waits for the jobs already running
+		~ChunkStreamer();
+		ChunkStreamer(const ChunkStreamer&) = delete;
+		ChunkStreamer& operator=(const ChunkStreamer&) = delete;
+
+		// Call once per frame from the thread that owns the GL context
+		void update(const glm::mat4& viewMatrix);
+		// addDraw every uploaded section inside the frustum, returns how many
+		size_t submitDraws(const Culling::Frustum& frustum);
+
+		const StreamingStats& stats() const { return totals; }
+		size_t residentColumns() const { return columns.size(); }
+		size_t drawableColumns() const;
+		bool isColumnDrawable(int chunkX, int chunkZ) const;
+		size_t jobsInFlight() const { return tasksInFlight.size(); }
+	};
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "core.h"
+#include "engine/chunk.h"
+#include "engine/noise.h"
+
+namespace Engine {
+	// Fills chunks from a 2D fBm heightmap with 3D fBm caves carved out
+	// generate() keeps no shared state, so it can run on several job threads at once
+	class TerrainGenerator {
+	private:
+		Noise::Isa isa;
+		Noise::FbmSettings heightNoise;
+		Noise::FbmSettings caveNoise;
+		int baseHeight;
+		int heightRange;
+		int seaLevel;
+
+	public:
+		TerrainGenerator(int32_t seed, Noise::Isa isa = Cpu::bestIsa());
+
+		void generate(Chunk& chunk, int chunkX, int chunkZ) const;
+		Noise::Isa getIsa() const { return isa; }
+	};
+}
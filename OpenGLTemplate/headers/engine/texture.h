@@ -0,0 +1,35 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	// Unit the block texture array is bound to, terrain shaders declare it with layout(binding = 0)
+	static constexpr GLuint BLOCK_TEXTURE_UNIT = 0;
+
+	// Immutable GL_TEXTURE_2D_ARRAY built from a list of PNGs, one layer each in list order
+	// The images are decoded in parallel on the job system (inline when it is not running), must all
+	// share one size and get a full mip chain. Nearest filtering up close for crisp texels, linear
+	// between mip levels further away, REPEAT wrapping so greedy quads can tile a layer
+	// Needs a current context, construct and use on the GL thread
+	class TextureArray {
+	private:
+		GLuint textureID;
+		int width;
+		int height;
+		int layers;
+		int levels;
+
+	public:
+		TextureArray(const std::vector<std::string>& paths);
+		~TextureArray();
+		TextureArray(const TextureArray&) = delete;
+		TextureArray& operator=(const TextureArray&) = delete;
+
+		void bind(GLuint unit = BLOCK_TEXTURE_UNIT) const;
+
+		GLuint id() const { return textureID; }
+		int getWidth() const { return width; }
+		int getHeight() const { return height; }
+		int getLayers() const { return layers; }
+		int getLevels() const { return levels; }
+	};
+}
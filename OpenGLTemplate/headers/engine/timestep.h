@@ -0,0 +1,49 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	// Ticks per second and the catch-up limits of a FixedTimestep
+	// maxFrameSeconds caps the real time a single frame can add (a debugger break or a window drag
+	// would otherwise queue seconds of ticks), maxTicksPerFrame caps the ticks run in one frame,
+	// time beyond it is dropped so the simulation slows down instead of spiralling
+	struct TimestepSettings {
+		double ticksPerSecond;
+		int maxTicksPerFrame;
+		double maxFrameSeconds;
+	};
+
+	const TimestepSettings defaultTimestep = { 20.0, 5, 0.25 };
+
+	// Accumulates real frame time and hands out fixed ticks, so simulation speed and cost do not
+	// depend on the frame rate. Per frame:
+	//   int ticks = timestep.advance(frameSeconds);
+	//   for (int i = 0; i < ticks; i++) { previous = current; tick(current, timestep.tickSeconds()); }
+	//   render(mix(previous, current, timestep.alpha()));
+	// Rendering thus lags the simulation by up to one tick in exchange for smooth motion
+	class FixedTimestep {
+	public:
+		struct Stats {
+			uint64_t frames;
+			uint64_t ticks;
+			uint64_t droppedTicks;		// Ticks skipped by the catch-up limits
+			int maxTicksInFrame;
+		};
+
+	private:
+		TimestepSettings settings;
+		double tickDuration;
+		double accumulator;
+		Stats frameStats;
+
+	public:
+		FixedTimestep(const TimestepSettings& settings = defaultTimestep);
+
+		// Adds the real time since the last call, returns how many ticks to run this frame
+		int advance(double frameSeconds);
+		// Fraction of a tick accumulated but not simulated yet, in [0, 1), blend factor for rendering
+		float alpha() const { return (float)(accumulator / tickDuration); }
+		double tickSeconds() const { return tickDuration; }
+		const TimestepSettings& getSettings() const { return settings; }
+		const Stats& stats() const { return frameStats; }
+	};
+}
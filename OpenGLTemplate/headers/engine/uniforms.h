@@ -0,0 +1,43 @@
+#pragma once
+#include "core.h"
+
+namespace Engine {
+	// Every Shader binds its FrameData block here, so one buffer update serves all programs
+	const GLuint FRAME_UNIFORM_BINDING = 0;
+
+	// std140 mirror of the FrameData block declared in the shaders, vec3s are padded to vec4
+	struct FrameData {
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::mat4 viewProjection;
+		glm::vec4 cameraPosition;	// w unused
+		glm::vec4 fogColor;			// a unused
+		float time;
+		float fogStart;				// Fog is off while fogEnd <= fogStart
+		float fogEnd;
+		float padding;
+	};
+	static_assert(sizeof(FrameData) == 240, "FrameData must match the std140 block layout");
+
+	// Uniform buffer with the frame-global data, written once per frame and left bound
+	class FrameUniforms {
+	private:
+		GLuint bufferId;
+		FrameData data;
+
+	public:
+		FrameUniforms();
+		~FrameUniforms();
+		FrameUniforms(const FrameUniforms&) = delete;
+		FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+		// Fills view, projection, viewProjection and cameraPosition from the two matrices
+		void setCamera(const glm::mat4& view, const glm::mat4& projection);
+		void setTime(float seconds) { data.time = seconds; }
+		void setFog(const glm::vec3& color, float start, float end);
+		// Upload and bind to FRAME_UNIFORM_BINDING
+		void update();
+
+		const FrameData& getData() const { return data; }
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "core.h"
+#include "engine/culling.h"
+#include "engine/mesher.h"
+
+namespace Engine {
+	struct VisibilityStats {
+		size_t sectionsTested;	// Frustum tests done while searching
+		size_t sectionsVisible;
+	};
+
+	// Cave culling over a box of loaded sections: a breadth-first search from the camera section
+	// only steps from the face it entered through to faces the flood fill found connected, and
+	// never back towards the camera, so sections sealed off by terrain are never reached
+	class VisibilityGraph {
+	private:
+		glm::ivec3 origin;	// Section coordinate of the first cell
+		glm::ivec3 size;
+		std::vector<Mesher::FaceConnectivity> connectivity;
+
+		// Per-search state, reset by bumping the stamp instead of clearing
+		std::vector<uint32_t> visitedStamp;
+		std::vector<uint8_t> entryFace;
+		std::vector<uint8_t> directions;
+		std::vector<uint32_t> queue;
+		uint32_t stamp;
+		VisibilityStats lastStats;
+
+		int cellIndex(const glm::ivec3& section) const {
+			glm::ivec3 p = section - origin;
+			return (p.y * size.z + p.z) * size.x + p.x;
+		}
+
+	public:
+		// Sections start fully connected, as if they were air
+		VisibilityGraph(const glm::ivec3& originSection, const glm::ivec3& sizeInSections);
+
+		bool contains(const glm::ivec3& section) const;
+		void setConnectivity(const glm::ivec3& section, Mesher::FaceConnectivity faces);
+		Mesher::FaceConnectivity getConnectivity(const glm::ivec3& section) const { return connectivity[cellIndex(section)]; }
+
+		// Cell index of a section, sectionAt(index) is the inverse
+		int indexOf(const glm::ivec3& section) const { return cellIndex(section); }
+		glm::ivec3 sectionAt(int index) const;
+		size_t cellCount() const { return connectivity.size(); }
+
+		// Writes the cell indices of reachable sections inside the frustum in breadth-first order,
+		// so nearer sections come first. A camera outside the box starts from the nearest section
+		void findVisible(const glm::vec3& cameraPosition, const Culling::Frustum& frustum, std::vector<uint32_t>& visible);
+		const VisibilityStats& stats() const { return lastStats; }
+	};
+}
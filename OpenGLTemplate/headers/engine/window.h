@@ -6,10 +6,15 @@ namespace Engine {
 		extern GLFWwindow* nativeWindow;
 		extern int windowWidth;
 		extern int windowHeight;
+		// Kept by the focus / iconify callbacks, the main loop throttles itself when unwatched
+		extern bool focused;
+		extern bool iconified;
 
-		bool createWindow(int width, int height, const char* title, bool fullScreenMode);
+		bool createWindow(int width, int height, const char* title, bool fullScreenMode, bool hidden = false);
 		void addWindowCallbacks();
 		void windowResizeCallback(GLFWwindow* window, int width, int height);
+		void windowFocusCallback(GLFWwindow* window, int windowFocused);
+		void windowIconifyCallback(GLFWwindow* window, int windowIconified);
 		void close();
 	}
 }
\ No newline at end of file
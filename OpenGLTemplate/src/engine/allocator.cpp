@@ -0,0 +1,176 @@
+#include "engine/allocator.h"
+#include "engine/renderState.h"
+
+namespace Engine {
+	namespace Buffers {
+		BufferArena::BufferArena(GLsizeiptr pageSize, GLsizeiptr alignment)
+			: pageSize(pageSize), alignment(alignment > 0 ? alignment : 1), usedBytes(0) {
+			// Handle 0 is reserved as InvalidHandle
+			slots.push_back({ 0, 0, 0, false });
+		}
+
+		BufferArena::~BufferArena() {
+			for (Page& page : pages) {
+				glDeleteBuffers(1, &page.bufferId);
+				RenderState::forgetBuffer(page.bufferId);
+			}
+		}
+
+		uint32_t BufferArena::addPage(GLsizeiptr minSize) {
+			Page page;
+			page.size = alignUp(std::max(pageSize, minSize));
+			glCreateBuffers(1, &page.bufferId);
+			glNamedBufferStorage(page.bufferId, page.size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+			pages.push_back(page);
+
+			uint32_t pageIndex = (uint32_t)(pages.size() - 1);
+			insertFreeBlock(pageIndex, 0, pages[pageIndex].size);
+			return pageIndex;
+		}
+
+		void BufferArena::insertFreeBlock(uint32_t page, GLintptr offset, GLsizeiptr size) {
+			pages[page].freeBlocks[offset] = size;
+			freeBySize.insert(std::make_tuple(size, page, offset));
+		}
+
+		void BufferArena::eraseFreeBlock(uint32_t page, GLintptr offset, GLsizeiptr size) {
+			pages[page].freeBlocks.erase(offset);
+			freeBySize.erase(std::make_tuple(size, page, offset));
+		}
+
+		BufferArena::Handle BufferArena::allocate(GLsizeiptr byteSize) {
+			GLsizeiptr size = alignUp(byteSize > 0 ? byteSize : 1);
+
+			// Best fit, smallest free block that is large enough
+			auto it = freeBySize.lower_bound(std::make_tuple(size, (uint32_t)0, (GLintptr)0));
+			uint32_t page;
+			GLintptr offset;
+			GLsizeiptr blockSize;
+			if (it != freeBySize.end()) {
+				std::tie(blockSize, page, offset) = *it;
+			}
+			else {
+				page = addPage(size);
+				offset = 0;
+				blockSize = pages[page].size;
+			}
+			eraseFreeBlock(page, offset, blockSize);
+			if (blockSize > size) {
+				insertFreeBlock(page, offset + size, blockSize - size);
+			}
+
+			Handle handle;
+			if (!freeSlots.empty()) {
+				handle = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			else {
+				handle = (Handle)slots.size();
+				slots.push_back({});
+			}
+			slots[handle] = { page, offset, size, true };
+			pages[page].usedBlocks[offset] = handle;
+			usedBytes += size;
+			return handle;
+		}
+
+		void BufferArena::free(Handle handle) {
+			if (handle == InvalidHandle || handle >= slots.size() || !slots[handle].live) return;
+			Slot& slot = slots[handle];
+			Page& page = pages[slot.page];
+			page.usedBlocks.erase(slot.offset);
+			usedBytes -= slot.size;
+
+			// Coalesce with the neighbouring free blocks
+			GLintptr offset = slot.offset;
+			GLsizeiptr size = slot.size;
+			auto next = page.freeBlocks.lower_bound(offset);
+			if (next != page.freeBlocks.end() && next->first == offset + size) {
+				size += next->second;
+				eraseFreeBlock(slot.page, next->first, next->second);
+			}
+			auto prev = page.freeBlocks.lower_bound(offset);
+			if (prev != page.freeBlocks.begin()) {
+				--prev;
+				if (prev->first + prev->second == offset) {
+					offset = prev->first;
+					size += prev->second;
+					eraseFreeBlock(slot.page, prev->first, prev->second);
+				}
+			}
+			insertFreeBlock(slot.page, offset, size);
+
+			slot.live = false;
+			freeSlots.push_back(handle);
+		}
+
+		void BufferArena::upload(Handle handle, const void* data, GLsizeiptr byteSize, GLintptr byteOffset) {
+			if (handle == InvalidHandle || handle >= slots.size() || !slots[handle].live) {
+				throw std::runtime_error("ERROR::BUFFERS::ARENA_UPLOAD_OUT_OF_RANGE");
+			}
+			const Slot& slot = slots[handle];
+			if (byteOffset + byteSize > slot.size) {
+				throw std::runtime_error("ERROR::BUFFERS::ARENA_UPLOAD_OUT_OF_RANGE");
+			}
+			glNamedBufferSubData(pages[slot.page].bufferId, slot.offset + byteOffset, byteSize, data);
+		}
+
+		Allocation BufferArena::get(Handle handle) const {
+			if (handle == InvalidHandle || handle >= slots.size() || !slots[handle].live) return { 0, 0, 0 };
+			const Slot& slot = slots[handle];
+			return { pages[slot.page].bufferId, slot.offset, slot.size };
+		}
+
+		bool BufferArena::defragment() {
+			bool moved = false;
+			for (uint32_t pageIndex = 0; pageIndex < pages.size(); pageIndex++) {
+				Page& page = pages[pageIndex];
+				// Already compact: no free space, or one free block at the very end
+				if (page.freeBlocks.empty()) continue;
+				if (page.freeBlocks.size() == 1 && page.freeBlocks.begin()->first + page.freeBlocks.begin()->second == page.size) continue;
+
+				// Copy live blocks packed into a new buffer, GL does not allow overlapping copies within one buffer
+				GLuint newBufferId;
+				glCreateBuffers(1, &newBufferId);
+				glNamedBufferStorage(newBufferId, page.size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+				std::map<GLintptr, Handle> packedBlocks;
+				GLintptr cursor = 0;
+				for (const auto& block : page.usedBlocks) {
+					Slot& slot = slots[block.second];
+					glCopyNamedBufferSubData(page.bufferId, newBufferId, slot.offset, cursor, slot.size);
+					slot.offset = cursor;
+					packedBlocks[cursor] = block.second;
+					cursor += slot.size;
+				}
+				glDeleteBuffers(1, &page.bufferId);
+				RenderState::forgetBuffer(page.bufferId);
+				page.bufferId = newBufferId;
+				page.usedBlocks.swap(packedBlocks);
+
+				for (const auto& block : page.freeBlocks) {
+					freeBySize.erase(std::make_tuple(block.second, pageIndex, block.first));
+				}
+				page.freeBlocks.clear();
+				if (cursor < page.size) {
+					insertFreeBlock(pageIndex, cursor, page.size - cursor);
+				}
+				moved = true;
+			}
+			return moved;
+		}
+
+		ArenaStats BufferArena::stats() const {
+			ArenaStats stats = {};
+			stats.pageCount = pages.size();
+			stats.allocationCount = slots.size() - 1 - freeSlots.size();
+			stats.freeBlockCount = freeBySize.size();
+			for (const Page& page : pages) stats.capacity += page.size;
+			stats.usedBytes = usedBytes;
+			stats.freeBytes = stats.capacity - usedBytes;
+			stats.largestFreeBlock = freeBySize.empty() ? 0 : std::get<0>(*freeBySize.rbegin());
+			stats.fragmentation = stats.freeBytes > 0 ? 1.0f - (float)stats.largestFreeBlock / (float)stats.freeBytes : 0.0f;
+			return stats;
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#include "engine/blocks.h"
+
+namespace Engine {
+	namespace Blocks {
+		// File names of the texture layers, in TextureLayer order
+		static const char* const layerNames[LAYER_COUNT] = { "stone", "dirt", "grass_top", "grass_side", "sand", "bedrock" };
+
+		// Per block: +X -X +Y -Y +Z -Z
+		static const int faceLayers[COUNT][FACE_COUNT] = {
+			{ 0, 0, 0, 0, 0, 0 },																				// Air
+			{ LAYER_STONE, LAYER_STONE, LAYER_STONE, LAYER_STONE, LAYER_STONE, LAYER_STONE },					// Stone
+			{ LAYER_DIRT, LAYER_DIRT, LAYER_DIRT, LAYER_DIRT, LAYER_DIRT, LAYER_DIRT },							// Dirt
+			{ LAYER_GRASS_SIDE, LAYER_GRASS_SIDE, LAYER_GRASS_TOP, LAYER_DIRT, LAYER_GRASS_SIDE, LAYER_GRASS_SIDE },	// Grass
+			{ LAYER_SAND, LAYER_SAND, LAYER_SAND, LAYER_SAND, LAYER_SAND, LAYER_SAND },							// Sand
+			{ LAYER_BEDROCK, LAYER_BEDROCK, LAYER_BEDROCK, LAYER_BEDROCK, LAYER_BEDROCK, LAYER_BEDROCK },		// Bedrock
+		};
+
+		int textureLayer(BlockId block, int face) {
+			if (block >= COUNT || face < 0 || face >= FACE_COUNT) return 0;
+			return faceLayers[block][face];
+		}
+
+		std::vector<std::string> texturePaths(const std::string& directory) {
+			std::vector<std::string> paths;
+			for (const char* name : layerNames) paths.push_back(directory + "/" + name + ".png");
+			return paths;
+		}
+	}
+}
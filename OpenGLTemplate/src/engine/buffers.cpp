@@ -1,20 +1,22 @@
 #include "core.h"
-#include "engine/shader.h"
+#include "engine/buffers.h"
+#include "engine/renderState.h"
 
 namespace Engine {
 	namespace Buffers {
 		GLuint createVAO() {
 			unsigned int vaoID;
 			glCreateVertexArrays(1, &vaoID);
-			glBindVertexArray(vaoID);
+			RenderState::bindVertexArray(vaoID);
 			return vaoID;
 		}
 
-		void createVBO(GLuint vaoID, GLsizeiptr verticesByteSize, const void* vertices, GLuint bindingIndex, int vertexLen, GLenum usage) {
+		GLuint createVBO(GLuint vaoID, GLsizeiptr verticesByteSize, const void* vertices, GLuint bindingIndex, int vertexLen, GLenum usage) {
 			GLuint vboID;
 			glCreateBuffers(1, &vboID);
 			glNamedBufferData(vboID, verticesByteSize, vertices, usage);
 			glVertexArrayVertexBuffer(vaoID, bindingIndex, vboID, 0, vertexLen * sizeof(float));
+			return vboID;
 		}
 
 		void addVertexAttrib(GLuint vaoID, GLuint location, GLuint attribLen, GLuint offset, GLuint bindingIndex) {
@@ -23,19 +25,95 @@ namespace Engine {
 			glEnableVertexArrayAttrib(vaoID, location);
 		}
 
-		void createEBO(GLuint vaoID, GLsizeiptr indicesByteSize, GLuint* indices, GLenum usage) {
+		// Integer attributes are not converted to float, read them as int / uint / uvecN in the shader
+		void addIntegerVertexAttrib(GLuint vaoID, GLuint location, GLuint attribLen, GLenum type, GLuint offset, GLuint bindingIndex) {
+			glVertexArrayAttribIFormat(vaoID, location, attribLen, type, offset);
+			glVertexArrayAttribBinding(vaoID, location, bindingIndex);
+			glEnableVertexArrayAttrib(vaoID, location);
+		}
+
+		GLuint createEBO(GLuint vaoID, GLsizeiptr indicesByteSize, GLuint* indices, GLenum usage) {
 			GLuint eboID;
 			glCreateBuffers(1, &eboID);
 			glNamedBufferData(eboID, indicesByteSize, indices, usage);
 			glVertexArrayElementBuffer(vaoID, eboID);
+			return eboID;
 		}
 
+		// Redundant binds are skipped by RenderState
 		void useVAO(GLuint vaoID) {
-			glBindVertexArray(vaoID);
+			RenderState::bindVertexArray(vaoID);
 		}
 
 		void unbindVAO() {
-			glBindVertexArray(0);
+			RenderState::bindVertexArray(0);
+		}
+
+		// Stream buffer
+		StreamBuffer::StreamBuffer(GLsizeiptr segmentSize, int segmentCount)
+			: bufferId(0), mappedPtr(nullptr), segmentSize(segmentSize), segmentCount(segmentCount),
+			currentSegment(-1), writeCursor(segmentSize), segmentFences(segmentCount, nullptr), stallCount(0) {
+			// Immutable storage mapped once for the lifetime of the buffer, coherent so no explicit flushes are needed
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			glCreateBuffers(1, &bufferId);
+			glNamedBufferStorage(bufferId, segmentSize * segmentCount, nullptr, flags);
+			mappedPtr = (char*)glMapNamedBufferRange(bufferId, 0, segmentSize * segmentCount, flags);
+			if (mappedPtr == nullptr) {
+				glDeleteBuffers(1, &bufferId);
+				throw std::runtime_error("ERROR::BUFFERS::STREAM_BUFFER_MAP_FAILED");
+			}
+		}
+
+		StreamBuffer::~StreamBuffer() {
+			for (GLsync fence : segmentFences) {
+				if (fence != nullptr) glDeleteSync(fence);
+			}
+			glUnmapNamedBuffer(bufferId);
+			glDeleteBuffers(1, &bufferId);
+			RenderState::forgetBuffer(bufferId);
+		}
+
+		void StreamBuffer::beginSegment() {
+			currentSegment = (currentSegment + 1) % segmentCount;
+			writeCursor = 0;
+
+			GLsync& fence = segmentFences[currentSegment];
+			if (fence == nullptr) return;
+			// Poll first, only count a stall when we actually have to block on the GPU
+			GLenum result = glClientWaitSync(fence, 0, 0);
+			if (result == GL_TIMEOUT_EXPIRED) {
+				stallCount++;
+				do {
+					result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+				} while (result == GL_TIMEOUT_EXPIRED);
+			}
+			glDeleteSync(fence);
+			fence = nullptr;
+		}
+
+		void* StreamBuffer::reserve(GLsizeiptr byteSize, GLsizeiptr alignment, GLintptr& offset) {
+			GLsizeiptr alignedCursor = (writeCursor + alignment - 1) / alignment * alignment;
+			if (currentSegment < 0 || alignedCursor + byteSize > segmentSize) {
+				throw std::runtime_error("ERROR::BUFFERS::STREAM_BUFFER_SEGMENT_FULL");
+			}
+			writeCursor = alignedCursor + byteSize;
+			offset = (GLintptr)currentSegment * segmentSize + alignedCursor;
+			return mappedPtr + offset;
+		}
+
+		GLintptr StreamBuffer::write(const void* data, GLsizeiptr byteSize, GLsizeiptr alignment) {
+			GLintptr offset;
+			void* dst = reserve(byteSize, alignment, offset);
+			memcpy(dst, data, byteSize);
+			return offset;
+		}
+
+		void StreamBuffer::endSegment() {
+			if (currentSegment < 0) return;
+			// Ending twice replaces the fence, the newer one covers every command the old one did
+			GLsync& fence = segmentFences[currentSegment];
+			if (fence != nullptr) glDeleteSync(fence);
+			fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 		}
 	}
 }
\ No newline at end of file
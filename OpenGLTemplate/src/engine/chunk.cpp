@@ -0,0 +1,304 @@
+#include "engine/chunk.h"
+#include "engine/mesher.h"
+
+#include <algorithm>
+#include <bitset>
+
+namespace Engine {
+	ChunkSection::ChunkSection(BlockId fill) {
+		this->fill(fill);
+	}
+
+	void ChunkSection::fill(BlockId block) {
+		palette.assign(1, block);
+		paletteCounts.assign(1, (uint16_t)VOLUME);
+		palette.shrink_to_fit();
+		paletteCounts.shrink_to_fit();
+		data.clear();
+		data.shrink_to_fit();
+		bitsPerEntry = 0;
+		entriesPerWordLog2 = 0;
+		liveEntries = 1;
+		directWrites = 0;
+	}
+
+	// Re-encode every block at a new index width, palette order follows first appearance
+	void ChunkSection::repack(int newBits, const std::vector<BlockId>& blocks) {
+		palette.clear();
+		paletteCounts.clear();
+		liveEntries = 0;
+		directWrites = 0;
+		bitsPerEntry = newBits;
+		entriesPerWordLog2 = 0;
+		while ((64 >> entriesPerWordLog2) > newBits) entriesPerWordLog2++;
+		data.assign(VOLUME >> entriesPerWordLog2, 0);
+		data.shrink_to_fit();
+
+		for (int i = 0; i < VOLUME; i++) {
+			if (bitsPerEntry == DIRECT_BITS) {
+				setEntry(i, blocks[i]);
+				continue;
+			}
+			uint32_t entry = 0;
+			while (entry < palette.size() && palette[entry] != blocks[i]) entry++;
+			if (entry == palette.size()) {
+				palette.push_back(blocks[i]);
+				paletteCounts.push_back(0);
+				liveEntries++;
+			}
+			paletteCounts[entry]++;
+			setEntry(i, entry);
+		}
+		palette.shrink_to_fit();
+		paletteCounts.shrink_to_fit();
+	}
+
+	uint32_t ChunkSection::addPaletteEntry(BlockId block) {
+		// Reuse a slot whose block is gone before growing the palette
+		for (uint32_t entry = 0; entry < palette.size(); entry++) {
+			if (paletteCounts[entry] == 0) {
+				palette[entry] = block;
+				liveEntries++;
+				return entry;
+			}
+		}
+		palette.push_back(block);
+		paletteCounts.push_back(0);
+		liveEntries++;
+		return (uint32_t)palette.size() - 1;
+	}
+
+	void ChunkSection::set(int x, int y, int z, BlockId block) {
+		if (get(x, y, z) == block) return;
+		const int index = blockIndex(x, y, z);
+
+		if (bitsPerEntry == DIRECT_BITS) {
+			setEntry(index, block);
+			if (++directWrites >= VOLUME) optimize();
+			return;
+		}
+
+		// Grow the index width when the palette is full
+		uint32_t entry = 0;
+		while (entry < palette.size() && (palette[entry] != block || paletteCounts[entry] == 0)) entry++;
+		if (entry == palette.size() && liveEntries == (1 << bitsPerEntry)) {
+			std::vector<BlockId> blocks(VOLUME);
+			for (int i = 0; i < VOLUME; i++) blocks[i] = get(i % SIZE, i / (SIZE * SIZE), (i / SIZE) % SIZE);
+			blocks[index] = block;
+			int newBits = bitsPerEntry == 0 ? 1 : bitsPerEntry * 2;
+			repack(newBits > MAX_PALETTE_BITS ? DIRECT_BITS : newBits, blocks);
+			return;
+		}
+		if (entry == palette.size()) entry = addPaletteEntry(block);
+
+		uint32_t oldEntry = getEntry(index);
+		setEntry(index, entry);
+		paletteCounts[entry]++;
+		if (--paletteCounts[oldEntry] == 0) {
+			liveEntries--;
+			// Shrink once the palette fits in half of the next smaller width, so a block
+			// toggling at the boundary does not repack on every set
+			if (liveEntries == 1) {
+				fill(block);
+			}
+			else if (bitsPerEntry > 2 && liveEntries <= (1 << (bitsPerEntry / 2)) / 2) {
+				optimize();
+			}
+		}
+	}
+
+	void ChunkSection::assign(const BlockId* blocks) {
+		std::vector<BlockId> distinct;
+		for (int i = 0; i < VOLUME; i++) {
+			if (distinct.size() > (1u << MAX_PALETTE_BITS)) break;
+			if (std::find(distinct.begin(), distinct.end(), blocks[i]) == distinct.end()) distinct.push_back(blocks[i]);
+		}
+		if (distinct.size() == 1) {
+			fill(distinct[0]);
+			return;
+		}
+		int newBits = 1;
+		while ((size_t)(1 << newBits) < distinct.size() && newBits <= MAX_PALETTE_BITS) newBits *= 2;
+		repack(newBits > MAX_PALETTE_BITS ? DIRECT_BITS : newBits, std::vector<BlockId>(blocks, blocks + VOLUME));
+	}
+
+	void ChunkSection::optimize() {
+		std::vector<BlockId> blocks(VOLUME);
+		for (int i = 0; i < VOLUME; i++) blocks[i] = get(i % SIZE, i / (SIZE * SIZE), (i / SIZE) % SIZE);
+		assign(blocks.data());
+	}
+
+	size_t ChunkSection::memoryUsage() const {
+		return sizeof(ChunkSection) + palette.capacity() * sizeof(BlockId)
+			+ paletteCounts.capacity() * sizeof(uint16_t) + data.capacity() * sizeof(uint64_t);
+	}
+
+	// Serialized layout: u8 bitsPerEntry, u16 palette size, u16 palette entries, u64 index words
+	static void appendBytes(std::vector<uint8_t>& out, const void* data, size_t size) {
+		const uint8_t* bytes = (const uint8_t*)data;
+		out.insert(out.end(), bytes, bytes + size);
+	}
+
+	static bool readBytes(const uint8_t*& cursor, const uint8_t* end, void* data, size_t size) {
+		if ((size_t)(end - cursor) < size) return false;
+		memcpy(data, cursor, size);
+		cursor += size;
+		return true;
+	}
+
+	void ChunkSection::serialize(std::vector<uint8_t>& out) const {
+		uint8_t bits = (uint8_t)bitsPerEntry;
+		uint16_t paletteLength = (uint16_t)palette.size();
+		appendBytes(out, &bits, sizeof(bits));
+		appendBytes(out, &paletteLength, sizeof(paletteLength));
+		appendBytes(out, palette.data(), palette.size() * sizeof(BlockId));
+		appendBytes(out, data.data(), data.size() * sizeof(uint64_t));
+	}
+
+	bool ChunkSection::deserialize(const uint8_t*& cursor, const uint8_t* end) {
+		uint8_t bits = 0;
+		uint16_t paletteLength = 0;
+		if (!readBytes(cursor, end, &bits, sizeof(bits)) || !readBytes(cursor, end, &paletteLength, sizeof(paletteLength))) return false;
+		if (bits != 0 && bits != 1 && bits != 2 && bits != 4 && bits != 8 && bits != DIRECT_BITS) return false;
+		if (bits == DIRECT_BITS ? paletteLength != 0 : (paletteLength == 0 || paletteLength > (1 << bits))) return false;
+
+		std::vector<BlockId> newPalette(paletteLength);
+		if (!readBytes(cursor, end, newPalette.data(), paletteLength * sizeof(BlockId))) return false;
+		if (bits == 0) {
+			fill(newPalette[0]);
+			return true;
+		}
+
+		palette.swap(newPalette);
+		bitsPerEntry = bits;
+		entriesPerWordLog2 = 0;
+		while ((64 >> entriesPerWordLog2) > bits) entriesPerWordLog2++;
+		data.assign(VOLUME >> entriesPerWordLog2, 0);
+		data.shrink_to_fit();
+		if (!readBytes(cursor, end, data.data(), data.size() * sizeof(uint64_t))) {
+			fill(Blocks::AIR);
+			return false;
+		}
+
+		// Counts are not stored, rebuild them from the indices
+		directWrites = 0;
+		liveEntries = 0;
+		if (bitsPerEntry == DIRECT_BITS) {
+			paletteCounts.clear();
+			return true;
+		}
+		paletteCounts.assign(std::max(palette.size(), (size_t)1 << bitsPerEntry), 0);
+		const int entriesPerWord = 1 << entriesPerWordLog2;
+		const uint64_t entryMask = (1u << bitsPerEntry) - 1;
+		uint16_t* counts = paletteCounts.data();
+		if (bitsPerEntry <= 2) {
+			// Counting one entry at a time serializes on the same counter, popcount the bit planes instead
+			const uint64_t lowBits = bitsPerEntry == 1 ? ~0ull : 0x5555555555555555ull;
+			size_t planeCounts[4] = {};
+			for (uint64_t word : data) {
+				uint64_t low = word & lowBits;
+				uint64_t high = bitsPerEntry == 1 ? 0 : (word >> 1) & lowBits;
+				planeCounts[1] += std::bitset<64>(low & ~high).count();
+				planeCounts[2] += std::bitset<64>(high & ~low).count();
+				planeCounts[3] += std::bitset<64>(low & high).count();
+			}
+			counts[1] = (uint16_t)planeCounts[1];
+			if (bitsPerEntry == 2) {
+				counts[2] = (uint16_t)planeCounts[2];
+				counts[3] = (uint16_t)planeCounts[3];
+			}
+			counts[0] = (uint16_t)(VOLUME - planeCounts[1] - planeCounts[2] - planeCounts[3]);
+		}
+		else {
+			// Four sets of counters so runs of one entry do not wait on each other
+			uint16_t laneCounts[4][1 << MAX_PALETTE_BITS] = {};
+			for (uint64_t word : data) {
+				for (int k = 0; k < entriesPerWord; k++, word >>= bitsPerEntry) laneCounts[k & 3][word & entryMask]++;
+			}
+			for (uint64_t entry = 0; entry <= entryMask; entry++) {
+				counts[entry] = (uint16_t)(laneCounts[0][entry] + laneCounts[1][entry] + laneCounts[2][entry] + laneCounts[3][entry]);
+			}
+		}
+		// Indices past the palette would land in the padding of the count table
+		if (palette.size() < (size_t)(entryMask + 1)) {
+			for (size_t entry = palette.size(); entry <= entryMask; entry++) {
+				if (paletteCounts[entry] != 0) {
+					fill(Blocks::AIR);
+					return false;
+				}
+			}
+			paletteCounts.resize(palette.size());
+		}
+		for (uint16_t count : paletteCounts) liveEntries += count > 0 ? 1 : 0;
+		return true;
+	}
+
+	// Chunk
+	Chunk::Chunk(int sectionCount) : sections(sectionCount) {
+	}
+
+	void Chunk::serialize(std::vector<uint8_t>& out) const {
+		uint16_t count = (uint16_t)sections.size();
+		appendBytes(out, &count, sizeof(count));
+		for (const ChunkSection& section : sections) section.serialize(out);
+	}
+
+	bool Chunk::deserialize(const uint8_t* data, size_t size) {
+		const uint8_t* cursor = data;
+		const uint8_t* end = data + size;
+		uint16_t count = 0;
+		if (!readBytes(cursor, end, &count, sizeof(count))) return false;
+		sections.assign(count, ChunkSection());
+		for (ChunkSection& section : sections) {
+			if (!section.deserialize(cursor, end)) return false;
+		}
+		return cursor == end;
+	}
+
+	void Chunk::optimize() {
+		for (ChunkSection& section : sections) section.optimize();
+	}
+
+	size_t Chunk::memoryUsage() const {
+		size_t total = sizeof(Chunk);
+		for (const ChunkSection& section : sections) total += section.memoryUsage();
+		return total;
+	}
+
+	void buildPaddedSection(const Chunk* const neighbourhood[9], int sectionY, BlockId* padded) {
+		const int size = ChunkSection::SIZE;
+		for (int z = -1; z <= size; z++) {
+			const int dz = z < 0 ? -1 : (z >= size ? 1 : 0);
+			for (int x = -1; x <= size; x++) {
+				const int dx = x < 0 ? -1 : (x >= size ? 1 : 0);
+				const Chunk* chunk = neighbourhood[(dz + 1) * 3 + (dx + 1)];
+				const int localX = x - dx * size;
+				const int localZ = z - dz * size;
+				for (int y = -1; y <= size; y++) {
+					padded[Mesher::paddedIndex(x, y, z)] = chunk != nullptr
+						? chunk->get(localX, sectionY * size + y, localZ)
+						: (BlockId)Blocks::AIR;
+				}
+			}
+		}
+	}
+
+	void buildLodPaddedSection(const Chunk* const neighbourhood[9], int sectionY, int lod, BlockId* padded) {
+		const int size = ChunkSection::SIZE;
+		const int padding = 1 << lod;
+		for (int z = -padding; z < size + padding; z++) {
+			const int dz = z < 0 ? -1 : (z >= size ? 1 : 0);
+			for (int x = -padding; x < size + padding; x++) {
+				const int dx = x < 0 ? -1 : (x >= size ? 1 : 0);
+				const Chunk* chunk = neighbourhood[(dz + 1) * 3 + (dx + 1)];
+				const int localX = x - dx * size;
+				const int localZ = z - dz * size;
+				for (int y = -padding; y < size + padding; y++) {
+					padded[Mesher::lodPaddedIndex(x, y, z)] = chunk != nullptr
+						? chunk->get(localX, sectionY * size + y, localZ)
+						: (BlockId)Blocks::AIR;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,49 @@
+#include "engine/cpu.h"
+
+#if defined(ENGINE_CPU_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace Engine {
+	namespace Cpu {
+		static bool detectIsa(Isa isa) {
+			if (isa == Isa::Scalar) return true;
+#if defined(ENGINE_CPU_X86) && defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 1);
+			const bool sse41 = (info[2] & (1 << 19)) != 0;
+			if (isa == Isa::SSE41) return sse41;
+			// AVX2 also needs the OS to save the YMM registers (OSXSAVE + XCR0 bits 1 and 2)
+			const bool osxsave = (info[2] & (1 << 27)) != 0;
+			if (!osxsave || (_xgetbv(0) & 6) != 6) return false;
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#elif defined(ENGINE_CPU_X86)
+			__builtin_cpu_init();
+			if (isa == Isa::SSE41) return __builtin_cpu_supports("sse4.1");
+			return __builtin_cpu_supports("avx2");
+#else
+			return false;
+#endif
+		}
+
+		bool isSupported(Isa isa) {
+			static const bool supported[3] = { detectIsa(Isa::Scalar), detectIsa(Isa::SSE41), detectIsa(Isa::AVX2) };
+			return supported[(int)isa];
+		}
+
+		Isa bestIsa() {
+			if (isSupported(Isa::AVX2)) return Isa::AVX2;
+			if (isSupported(Isa::SSE41)) return Isa::SSE41;
+			return Isa::Scalar;
+		}
+
+		const char* isaName(Isa isa) {
+			switch (isa) {
+			case Isa::SSE41: return "SSE4.1";
+			case Isa::AVX2: return "AVX2";
+			default: return "Scalar";
+			}
+		}
+	}
+}
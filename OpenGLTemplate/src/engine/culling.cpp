@@ -0,0 +1,131 @@
+#include "engine/culling.h"
+
+#ifdef ENGINE_CPU_X86
+#include <emmintrin.h>
+#endif
+
+namespace Engine {
+	namespace Culling {
+		Frustum extractFrustum(const glm::mat4& viewProjection) {
+			// glm is column-major, row i is (m[0][i], m[1][i], m[2][i], m[3][i])
+			const glm::mat4& m = viewProjection;
+			glm::vec4 row0 = glm::vec4(m[0][0], m[1][0], m[2][0], m[3][0]);
+			glm::vec4 row1 = glm::vec4(m[0][1], m[1][1], m[2][1], m[3][1]);
+			glm::vec4 row2 = glm::vec4(m[0][2], m[1][2], m[2][2], m[3][2]);
+			glm::vec4 row3 = glm::vec4(m[0][3], m[1][3], m[2][3], m[3][3]);
+
+			Frustum frustum;
+			frustum.planes[0] = row3 + row0;	// Left
+			frustum.planes[1] = row3 - row0;	// Right
+			frustum.planes[2] = row3 + row1;	// Bottom
+			frustum.planes[3] = row3 - row1;	// Top
+			frustum.planes[4] = row3 + row2;	// Near
+			frustum.planes[5] = row3 - row2;	// Far
+			for (glm::vec4& plane : frustum.planes) {
+				plane /= glm::length(glm::vec3(plane));
+			}
+			return frustum;
+		}
+
+		void AabbList::add(const glm::vec3& min, const glm::vec3& max) {
+			minX.push_back(min.x);
+			minY.push_back(min.y);
+			minZ.push_back(min.z);
+			maxX.push_back(max.x);
+			maxY.push_back(max.y);
+			maxZ.push_back(max.z);
+		}
+
+		void AabbList::clear() {
+			minX.clear(); minY.clear(); minZ.clear();
+			maxX.clear(); maxY.clear(); maxZ.clear();
+		}
+
+		void AabbList::reserve(size_t count) {
+			minX.reserve(count); minY.reserve(count); minZ.reserve(count);
+			maxX.reserve(count); maxY.reserve(count); maxZ.reserve(count);
+		}
+
+		// Only the box corner furthest along the plane normal (the p-vertex) needs testing
+		bool isAabbVisible(const Frustum& frustum, const glm::vec3& min, const glm::vec3& max) {
+			for (const glm::vec4& plane : frustum.planes) {
+				float x = plane.x > 0.0f ? max.x : min.x;
+				float y = plane.y > 0.0f ? max.y : min.y;
+				float z = plane.z > 0.0f ? max.z : min.z;
+				if (plane.x * x + plane.y * y + plane.z * z + plane.w < 0.0f) return false;
+			}
+			return true;
+		}
+
+		// Scalar reference, also handles the tail of the vector paths
+		static size_t cullScalar(const Frustum& frustum, const AabbList& boxes, size_t begin, uint32_t* visible) {
+			size_t count = 0;
+			for (size_t i = begin; i < boxes.size(); i++) {
+				bool inside = isAabbVisible(frustum,
+					glm::vec3(boxes.minX[i], boxes.minY[i], boxes.minZ[i]),
+					glm::vec3(boxes.maxX[i], boxes.maxY[i], boxes.maxZ[i]));
+				visible[count] = (uint32_t)i;
+				count += inside ? 1 : 0;
+			}
+			return count;
+		}
+
+#ifdef ENGINE_CPU_X86
+		// 4 boxes per iteration, SSE2 is all this needs
+		static size_t cullSse(const Frustum& frustum, const AabbList& boxes, uint32_t* visible, size_t& processed) {
+			const float* pX[6];
+			const float* pY[6];
+			const float* pZ[6];
+			for (int p = 0; p < 6; p++) {
+				pX[p] = frustum.planes[p].x > 0.0f ? boxes.maxX.data() : boxes.minX.data();
+				pY[p] = frustum.planes[p].y > 0.0f ? boxes.maxY.data() : boxes.minY.data();
+				pZ[p] = frustum.planes[p].z > 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+			}
+
+			size_t count = 0;
+			size_t i = 0;
+			const __m128 zero = _mm_setzero_ps();
+			for (; i + 4 <= boxes.size(); i += 4) {
+				__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+				for (int p = 0; p < 6; p++) {
+					const glm::vec4& plane = frustum.planes[p];
+					__m128 d = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+						_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(pX[p] + i)),
+						_mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(pY[p] + i))),
+						_mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(pZ[p] + i))),
+						_mm_set1_ps(plane.w));
+					inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+				}
+				// Branchless compaction, always write and only advance for visible boxes
+				int mask = _mm_movemask_ps(inside);
+				for (int k = 0; k < 4; k++) {
+					visible[count] = (uint32_t)(i + k);
+					count += (mask >> k) & 1;
+				}
+			}
+			processed = i;
+			return count;
+		}
+#endif
+
+		size_t cullAabbs(Cpu::Isa isa, const Frustum& frustum, const AabbList& boxes, std::vector<uint32_t>& visible) {
+			// One spare slot, the compaction writes an index before deciding whether to keep it
+			visible.resize(boxes.size() + 1);
+			size_t count = 0;
+			size_t processed = 0;
+			if (!Cpu::isSupported(isa)) isa = Cpu::bestIsa();
+#ifdef ENGINE_CPU_X86
+			if (isa == Cpu::Isa::AVX2) {
+				processed = boxes.size() / 8 * 8;
+				count = Detail::cullAabbsAvx2(frustum, boxes, processed, visible.data());
+			}
+			else if (isa == Cpu::Isa::SSE41) {
+				count = cullSse(frustum, boxes, visible.data(), processed);
+			}
+#endif
+			count += cullScalar(frustum, boxes, processed, visible.data() + count);
+			visible.resize(count);
+			return count;
+		}
+	}
+}
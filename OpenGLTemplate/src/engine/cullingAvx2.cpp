@@ -0,0 +1,45 @@
+// Built with AVX2 enabled (see CMakeLists.txt), only called after a CPU check
+#include "engine/culling.h"
+#ifdef ENGINE_CPU_X86
+
+#include <immintrin.h>
+
+namespace Engine {
+	namespace Culling {
+		namespace Detail {
+			// 8 boxes per iteration over [0, end), end must be a multiple of 8
+			size_t cullAabbsAvx2(const Frustum& frustum, const AabbList& boxes, size_t end, uint32_t* visible) {
+				const float* pX[6];
+				const float* pY[6];
+				const float* pZ[6];
+				for (int p = 0; p < 6; p++) {
+					pX[p] = frustum.planes[p].x > 0.0f ? boxes.maxX.data() : boxes.minX.data();
+					pY[p] = frustum.planes[p].y > 0.0f ? boxes.maxY.data() : boxes.minY.data();
+					pZ[p] = frustum.planes[p].z > 0.0f ? boxes.maxZ.data() : boxes.minZ.data();
+				}
+
+				size_t count = 0;
+				const __m256 zero = _mm256_setzero_ps();
+				for (size_t i = 0; i < end; i += 8) {
+					__m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+					for (int p = 0; p < 6; p++) {
+						const glm::vec4& plane = frustum.planes[p];
+						__m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+							_mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(pX[p] + i)),
+							_mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(pY[p] + i))),
+							_mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(pZ[p] + i))),
+							_mm256_set1_ps(plane.w));
+						inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+					}
+					int mask = _mm256_movemask_ps(inside);
+					for (int k = 0; k < 8; k++) {
+						visible[count] = (uint32_t)(i + k);
+						count += (mask >> k) & 1;
+					}
+				}
+				return count;
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,173 @@
+#include "engine/framePacer.h"
+#include "engine/profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace Engine {
+	FramePacer::FramePacer(const PacingSettings& settings)
+		: settings(settings), framePeriod(0.0), deadline(0.0), latchTime(0.0), frameIndex(0), fences(),
+		latencyCursor(0), gpuToCpuOffset(0.0), lastCalibration(-1.0e9),
+		sleepEstimate(0.005), sleepMean(0.005), sleepM2(0.0), sleepCount(1), frameStats() {
+		if (settings.mode == PresentMode::CAPPED && settings.capFps <= 0.0) throw std::runtime_error("ERROR::FRAME_PACER::INVALID_CAP");
+		if (settings.maxFramesInFlight < 0 || settings.maxFramesInFlight > MAX_FRAMES_IN_FLIGHT) throw std::runtime_error("ERROR::FRAME_PACER::INVALID_FRAMES_IN_FLIGHT");
+		if (settings.mode == PresentMode::CAPPED) framePeriod = 1.0 / settings.capFps;
+		latencies.reserve(LATENCY_HISTORY);
+	}
+
+	FramePacer::~FramePacer() {
+		for (GLsync& fence : fences) {
+			if (fence != 0) glDeleteSync(fence);
+		}
+		for (const PendingFrame& pending : pendingFrames) freeQueries.push_back(pending.query);
+		if (!freeQueries.empty()) glDeleteQueries((GLsizei)freeQueries.size(), freeQueries.data());
+	}
+
+	double FramePacer::now() {
+		static const Clock::time_point epoch = Clock::now();
+		return std::chrono::duration<double>(Clock::now() - epoch).count();
+	}
+
+	void FramePacer::beginFrame() {
+		PROFILE_SCOPE("Frame pacing");
+		collectLatencies();
+
+		// The frame maxFramesInFlight back has to be done on the GPU before this one starts
+		if (settings.maxFramesInFlight > 0 && frameIndex >= (uint64_t)settings.maxFramesInFlight) {
+			GLsync& fence = fences[(frameIndex - settings.maxFramesInFlight) % MAX_FRAMES_IN_FLIGHT];
+			if (fence != 0) {
+				double start = now();
+				GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+				while (glClientWaitSync(fence, flags, 1000000000) == GL_TIMEOUT_EXPIRED) flags = 0;
+				frameStats.gpuWaitMs += (now() - start) * 1000.0;
+				glDeleteSync(fence);
+				fence = 0;
+			}
+		}
+
+		if (settings.mode == PresentMode::CAPPED) {
+			double current = now();
+			// First frame or more than a frame behind: restart the cadence instead of rushing to catch up
+			if (deadline == 0.0 || current > deadline + framePeriod) {
+				deadline = current;
+			}
+			else {
+				waitUntil(deadline);
+				double end = now();
+				frameStats.limiterMs += (end - current) * 1000.0;
+				frameStats.maxOvershootMs = std::max(frameStats.maxOvershootMs, (end - deadline) * 1000.0);
+			}
+			deadline += framePeriod;
+		}
+		latchTime = now();
+	}
+
+	void FramePacer::markInputLatched() {
+		latchTime = now();
+	}
+
+	void FramePacer::endFrame() {
+		// The GPU clock can drift against the CPU one, resample every second
+		if (now() - lastCalibration > 1.0) calibrate();
+
+		GLuint query;
+		if (freeQueries.empty()) {
+			glCreateQueries(GL_TIMESTAMP, 1, &query);
+		}
+		else {
+			query = freeQueries.back();
+			freeQueries.pop_back();
+		}
+		glQueryCounter(query, GL_TIMESTAMP);
+		pendingFrames.push_back({ query, latchTime });
+		if (pendingFrames.size() > LATENCY_HISTORY) {
+			freeQueries.push_back(pendingFrames.front().query);
+			pendingFrames.erase(pendingFrames.begin());
+			frameStats.droppedLatencies++;
+		}
+
+		if (settings.maxFramesInFlight > 0) {
+			GLsync& fence = fences[frameIndex % MAX_FRAMES_IN_FLIGHT];
+			if (fence != 0) glDeleteSync(fence);
+			fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		}
+		frameIndex++;
+		frameStats.frames++;
+	}
+
+	void FramePacer::calibrate() {
+		GLint64 gpuNow = 0;
+		glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+		lastCalibration = now();
+		gpuToCpuOffset = lastCalibration - (double)gpuNow * 1.0e-9;
+	}
+
+	void FramePacer::collectLatencies() {
+		// Timestamps complete in order, stop at the first one not back yet
+		size_t collected = 0;
+		for (; collected < pendingFrames.size(); collected++) {
+			const PendingFrame& pending = pendingFrames[collected];
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(pending.query, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available == GL_FALSE) break;
+			GLuint64 gpuTime = 0;
+			glGetQueryObjectui64v(pending.query, GL_QUERY_RESULT, &gpuTime);
+			double ms = ((double)gpuTime * 1.0e-9 + gpuToCpuOffset - pending.latchTime) * 1000.0;
+			if (latencies.size() < LATENCY_HISTORY) latencies.push_back(ms);
+			else latencies[latencyCursor] = ms;
+			latencyCursor = (latencyCursor + 1) % LATENCY_HISTORY;
+			freeQueries.push_back(pending.query);
+		}
+		pendingFrames.erase(pendingFrames.begin(), pendingFrames.begin() + collected);
+	}
+
+	void FramePacer::waitUntil(double target) {
+		// Sleeps overshoot by the timer resolution (about 0.1 ms on Linux, up to 15.6 ms on Windows
+		// without timeBeginPeriod), learn by how much and spin once another sleep could be late
+		double remaining = target - now();
+		while (remaining > sleepEstimate) {
+			double start = now();
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			double observed = now() - start;
+			remaining -= observed;
+
+			// Running mean / variance, halved history so the estimate follows a changing system
+			if (sleepCount >= 1000) {
+				sleepCount /= 2;
+				sleepM2 *= 0.5;
+			}
+			sleepCount++;
+			double delta = observed - sleepMean;
+			sleepMean += delta / (double)sleepCount;
+			sleepM2 += delta * (observed - sleepMean);
+			sleepEstimate = sleepMean + std::sqrt(sleepM2 / (double)(sleepCount - 1));
+		}
+		while (now() < target) std::this_thread::yield();
+	}
+
+	std::vector<double> FramePacer::latencyMs() const {
+		if (latencies.size() < LATENCY_HISTORY) return latencies;
+		std::vector<double> ordered;
+		ordered.reserve(latencies.size());
+		ordered.insert(ordered.end(), latencies.begin() + latencyCursor, latencies.end());
+		ordered.insert(ordered.end(), latencies.begin(), latencies.begin() + latencyCursor);
+		return ordered;
+	}
+
+	void FramePacer::printStats() const {
+		const char* modes[] = { "vsync", "uncapped", "capped" };
+		std::vector<double> sorted = latencyMs();
+		std::sort(sorted.begin(), sorted.end());
+		double frames = (double)std::max<uint64_t>(frameStats.frames, 1);
+		printf("Frame pacing (%s", modes[(int)settings.mode]);
+		if (settings.mode == PresentMode::CAPPED) printf(" %.0f fps", settings.capFps);
+		printf(", %d frames in flight): %llu frames | limiter %.3f ms/frame, worst overshoot %.3f ms | GPU wait %.3f ms/frame\n",
+			settings.maxFramesInFlight, (unsigned long long)frameStats.frames, frameStats.limiterMs / frames,
+			frameStats.maxOvershootMs, frameStats.gpuWaitMs / frames);
+		if (!sorted.empty()) {
+			printf("Input-to-present latency (last %zu frames): p50 %.2f ms | p99 %.2f ms | max %.2f ms\n", sorted.size(),
+				sorted[sorted.size() / 2], sorted[std::min(sorted.size() - 1, (size_t)(sorted.size() * 0.99))], sorted.back());
+		}
+	}
+}
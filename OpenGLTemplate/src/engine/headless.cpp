@@ -0,0 +1,129 @@
+#include "engine/headless.h"
+#include "engine/renderState.h"
+
+// Keep Xlib macros (None, Status, ...) out of the engine
+#define EGL_NO_X11
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+namespace Engine {
+	namespace Headless {
+		int framebufferWidth = 0;
+		int framebufferHeight = 0;
+		GLuint fboID = 0;
+
+		static EGLDisplay display = EGL_NO_DISPLAY;
+		static EGLContext context = EGL_NO_CONTEXT;
+		static GLuint colorRBO = 0;
+		static GLuint depthRBO = 0;
+
+		static EGLDisplay getSurfacelessDisplay() {
+			// Prefer the Mesa surfaceless platform, it needs neither X11 nor a DRM device
+			PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+				(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+			if (getPlatformDisplay != nullptr) {
+				EGLDisplay surfaceless = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+				if (surfaceless != EGL_NO_DISPLAY) return surfaceless;
+			}
+			return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+		}
+
+		bool createContext(int width, int height) {
+			// Init EGL
+			display = getSurfacelessDisplay();
+			EGLint major, minor;
+			if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+				printf("Failed to initialize EGL.\n");
+				return false;
+			}
+			if (!eglBindAPI(EGL_OPENGL_API)) {
+				printf("EGL does not support desktop OpenGL.\n");
+				eglTerminate(display);
+				return false;
+			}
+
+			EGLint configAttribs[] = {
+				EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_NONE
+			};
+			EGLConfig config;
+			EGLint numConfigs = 0;
+			eglChooseConfig(display, configAttribs, &config, 1, &numConfigs);
+			if (numConfigs == 0) config = EGL_NO_CONFIG_KHR;
+
+			// Load OpenGL 4.6 Core Profile, fall back to 4.5 (DSA is the minimum we need)
+			const EGLint minorVersions[] = { 6, 5 };
+			for (EGLint minorVersion : minorVersions) {
+				EGLint contextAttribs[] = {
+					EGL_CONTEXT_MAJOR_VERSION, 4,
+					EGL_CONTEXT_MINOR_VERSION, minorVersion,
+					EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+					EGL_NONE
+				};
+				context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+				if (context != EGL_NO_CONTEXT) break;
+			}
+			if (context == EGL_NO_CONTEXT) {
+				printf("Failed to create EGL context.\n");
+				eglTerminate(display);
+				return false;
+			}
+			eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context);
+
+			// Init GLAD (Load OpenGL functions)
+			if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+				printf("Failed to initialize GLAD.\n");
+				destroyContext();
+				return false;
+			}
+			printf("Headless context: %s (%s)\n", glGetString(GL_VERSION), glGetString(GL_RENDERER));
+
+			// Offscreen framebuffer, there is no default framebuffer without a surface
+			glCreateRenderbuffers(1, &colorRBO);
+			glNamedRenderbufferStorage(colorRBO, GL_RGBA8, width, height);
+			glCreateRenderbuffers(1, &depthRBO);
+			glNamedRenderbufferStorage(depthRBO, GL_DEPTH24_STENCIL8, width, height);
+			glCreateFramebuffers(1, &fboID);
+			glNamedFramebufferRenderbuffer(fboID, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRBO);
+			glNamedFramebufferRenderbuffer(fboID, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthRBO);
+			if (glCheckNamedFramebufferStatus(fboID, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+				printf("Offscreen framebuffer is incomplete.\n");
+				destroyContext();
+				return false;
+			}
+
+			framebufferWidth = width;
+			framebufferHeight = height;
+			bindFramebuffer();
+			return true;
+		}
+
+		void bindFramebuffer() {
+			RenderState::bindFramebuffer(fboID);
+			glViewport(0, 0, framebufferWidth, framebufferHeight);
+		}
+
+		// Stand-in for glfwSwapBuffers, block until the GPU has finished the frame
+		void finishFrame() {
+			glFinish();
+		}
+
+		void destroyContext() {
+			if (context != EGL_NO_CONTEXT) {
+				if (fboID != 0) glDeleteFramebuffers(1, &fboID);
+				if (colorRBO != 0) glDeleteRenderbuffers(1, &colorRBO);
+				if (depthRBO != 0) glDeleteRenderbuffers(1, &depthRBO);
+				fboID = colorRBO = depthRBO = 0;
+				// A later context starts with nothing bound
+				RenderState::invalidate();
+				eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+				eglDestroyContext(display, context);
+				context = EGL_NO_CONTEXT;
+			}
+			if (display != EGL_NO_DISPLAY) {
+				eglTerminate(display);
+				display = EGL_NO_DISPLAY;
+			}
+		}
+	}
+}
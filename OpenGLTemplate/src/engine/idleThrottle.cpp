@@ -0,0 +1,25 @@
+#include "engine/idleThrottle.h"
+
+namespace Engine {
+	IdleThrottle::IdleThrottle(const WindowEventSource& source, const IdleSettings& settings)
+		: source(source), settings(settings), frameStats() {
+		if (settings.unfocusedFps <= 0.0) throw std::runtime_error("ERROR::IDLE_THROTTLE::INVALID_SETTINGS");
+	}
+
+	bool IdleThrottle::wait(const FixedTimestep& timestep) {
+		const bool wasIconified = source.iconified(), wasFocused = source.focused();
+		if (!wasIconified && wasFocused) return true;
+
+		double idleStart = source.now();
+		double wakeTime = idleStart + (wasIconified ? (1.0 - timestep.alpha()) * timestep.tickSeconds() : 1.0 / settings.unfocusedFps);
+		double now = idleStart;
+		// Other events (e.g. the cursor crossing the window) are dispatched but do not end the wait early
+		while (now < wakeTime && source.iconified() == wasIconified && source.focused() == wasFocused && !source.shouldClose()) {
+			source.waitEvents(wakeTime - now);
+			now = source.now();
+		}
+		frameStats.idleFrames++;
+		frameStats.idleSeconds += now - idleStart;
+		return !source.iconified();
+	}
+}
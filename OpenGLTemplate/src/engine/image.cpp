@@ -0,0 +1,424 @@
+#include "engine/image.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+namespace Engine {
+	namespace Png {
+		static void fail(const char* error) {
+			throw std::runtime_error(std::string("ERROR::IMAGE::") + error);
+		}
+
+		// LSB-first bit reader for deflate, refills 8 bytes at a time so a whole code fits
+		// Reads past the end return zeros, inflate checks the position once per block
+		struct BitReader {
+			const uint8_t* data;
+			size_t size;
+			size_t position = 0;	// Next byte to load into bits
+			uint64_t bits = 0;
+			int count = 0;
+
+			BitReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+			void refill() {
+				while (count <= 56) {
+					uint64_t byte = position < size ? data[position] : 0;
+					position++;
+					bits |= byte << count;
+					count += 8;
+				}
+			}
+			uint32_t peek(int n) const { return (uint32_t)(bits & ((1ull << n) - 1)); }
+			void consume(int n) {
+				bits >>= n;
+				count -= n;
+			}
+			uint32_t read(int n) {
+				if (n == 0) return 0;
+				refill();
+				uint32_t value = peek(n);
+				consume(n);
+				return value;
+			}
+			// Bytes actually consumed, loaded but unread bytes do not count
+			size_t consumed() const { return position - (size_t)(count / 8); }
+		};
+
+		// Canonical Huffman decoder: codes up to FAST_BITS resolve with one table lookup, longer
+		// ones walk the per-length counts
+		struct Huffman {
+			static constexpr int FAST_BITS = 10;
+			static constexpr int MAX_BITS = 15;
+
+			uint16_t fast[1 << FAST_BITS];		// (symbol << 4) | length, 0 for codes longer than FAST_BITS
+			uint16_t counts[MAX_BITS + 1];
+			uint16_t symbols[288];
+
+			void build(const uint8_t* lengths, int symbolCount) {
+				memset(fast, 0, sizeof(fast));
+				memset(counts, 0, sizeof(counts));
+				for (int i = 0; i < symbolCount; i++) counts[lengths[i]]++;
+				counts[0] = 0;
+
+				uint16_t offsets[MAX_BITS + 2] = {};
+				for (int length = 1; length <= MAX_BITS; length++) offsets[length + 1] = offsets[length] + counts[length];
+				uint32_t nextCode[MAX_BITS + 1] = {};
+				uint32_t code = 0;
+				for (int length = 1; length <= MAX_BITS; length++) {
+					code = (code + counts[length - 1]) << 1;
+					nextCode[length] = code;
+				}
+				for (int symbol = 0; symbol < symbolCount; symbol++) {
+					int length = lengths[symbol];
+					if (length == 0) continue;
+					symbols[offsets[length]++] = (uint16_t)symbol;
+					uint32_t symbolCode = nextCode[length]++;
+					if (length > FAST_BITS) continue;
+					// Deflate sends codes MSB first into an LSB-first stream, index the table bit-reversed
+					uint32_t reversed = 0;
+					for (int bit = 0; bit < length; bit++) reversed |= ((symbolCode >> bit) & 1u) << (length - 1 - bit);
+					for (uint32_t i = reversed; i < (1u << FAST_BITS); i += 1u << length) fast[i] = (uint16_t)((symbol << 4) | length);
+				}
+			}
+
+			int decode(BitReader& reader) const {
+				reader.refill();
+				uint16_t entry = fast[reader.peek(FAST_BITS)];
+				if (entry != 0) {
+					reader.consume(entry & 15);
+					return entry >> 4;
+				}
+				int code = 0, first = 0, index = 0;
+				for (int length = 1; length <= MAX_BITS; length++) {
+					code |= (int)((reader.bits >> (length - 1)) & 1u);
+					int count = counts[length];
+					if (code - first < count) {
+						reader.consume(length);
+						return symbols[index + code - first];
+					}
+					index += count;
+					first = (first + count) << 1;
+					code <<= 1;
+				}
+				fail("PNG_BAD_HUFFMAN_CODE");
+				return 0;
+			}
+		};
+
+		static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+		static const uint8_t codeLengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+		// zlib stream into exactly output.size() bytes, PNG knows the size from the header
+		static void inflate(const uint8_t* data, size_t size, std::vector<uint8_t>& output) {
+			if (size < 2 || (data[0] & 0x0F) != 8 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[1] & 0x20) != 0) fail("PNG_BAD_ZLIB_HEADER");
+			BitReader reader(data + 2, size - 2);
+			uint8_t* out = output.data();
+			const size_t outSize = output.size();
+			size_t written = 0;
+			Huffman literals, distances;
+
+			bool last = false;
+			while (!last) {
+				last = reader.read(1) != 0;
+				uint32_t type = reader.read(2);
+				if (type == 0) {
+					// Stored: realign on the byte stream and copy
+					reader.consume(reader.count % 8);
+					size_t position = reader.consumed();
+					reader.bits = 0;
+					reader.count = 0;
+					if (position + 4 > reader.size) fail("PNG_TRUNCATED_DATA");
+					const uint8_t* header = reader.data + position;
+					size_t length = header[0] | (header[1] << 8);
+					if ((length ^ (size_t)(header[2] | (header[3] << 8))) != 0xFFFF) fail("PNG_BAD_STORED_BLOCK");
+					position += 4;
+					if (position + length > reader.size) fail("PNG_TRUNCATED_DATA");
+					if (written + length > outSize) fail("PNG_DATA_TOO_LONG");
+					memcpy(out + written, reader.data + position, length);
+					written += length;
+					reader.position = position + length;
+					continue;
+				}
+
+				if (type == 1) {
+					uint8_t lengths[288 + 32];
+					memset(lengths, 8, 144);
+					memset(lengths + 144, 9, 112);
+					memset(lengths + 256, 7, 24);
+					memset(lengths + 280, 8, 8);
+					memset(lengths + 288, 5, 32);
+					literals.build(lengths, 288);
+					distances.build(lengths + 288, 30);
+				}
+				else if (type == 2) {
+					int literalCount = (int)reader.read(5) + 257;
+					int distanceCount = (int)reader.read(5) + 1;
+					int codeLengthCount = (int)reader.read(4) + 4;
+					if (literalCount > 286 || distanceCount > 30) fail("PNG_BAD_HUFFMAN_HEADER");
+					uint8_t codeLengthLengths[19] = {};
+					for (int i = 0; i < codeLengthCount; i++) codeLengthLengths[codeLengthOrder[i]] = (uint8_t)reader.read(3);
+					Huffman codeLengths;
+					codeLengths.build(codeLengthLengths, 19);
+
+					uint8_t lengths[286 + 30] = {};
+					int total = literalCount + distanceCount;
+					for (int i = 0; i < total;) {
+						int symbol = codeLengths.decode(reader);
+						if (symbol < 16) {
+							lengths[i++] = (uint8_t)symbol;
+							continue;
+						}
+						int repeat;
+						uint8_t value = 0;
+						if (symbol == 16) {
+							if (i == 0) fail("PNG_BAD_HUFFMAN_HEADER");
+							value = lengths[i - 1];
+							repeat = 3 + (int)reader.read(2);
+						}
+						else if (symbol == 17) repeat = 3 + (int)reader.read(3);
+						else repeat = 11 + (int)reader.read(7);
+						if (i + repeat > total) fail("PNG_BAD_HUFFMAN_HEADER");
+						memset(lengths + i, value, repeat);
+						i += repeat;
+					}
+					literals.build(lengths, literalCount);
+					distances.build(lengths + literalCount, distanceCount);
+				}
+				else {
+					fail("PNG_BAD_BLOCK_TYPE");
+				}
+
+				while (true) {
+					int symbol = literals.decode(reader);
+					if (symbol < 256) {
+						if (written >= outSize) fail("PNG_DATA_TOO_LONG");
+						out[written++] = (uint8_t)symbol;
+						continue;
+					}
+					if (symbol == 256) break;
+					symbol -= 257;
+					if (symbol >= 29) fail("PNG_BAD_LENGTH_CODE");
+					size_t length = lengthBase[symbol] + reader.read(lengthExtra[symbol]);
+					int distanceSymbol = distances.decode(reader);
+					if (distanceSymbol >= 30) fail("PNG_BAD_DISTANCE_CODE");
+					size_t distance = distanceBase[distanceSymbol] + reader.read(distanceExtra[distanceSymbol]);
+					if (distance > written) fail("PNG_BAD_DISTANCE");
+					if (written + length > outSize) fail("PNG_DATA_TOO_LONG");
+					const uint8_t* from = out + written - distance;
+					uint8_t* to = out + written;
+					// Overlapping copies repeat the last distance bytes, go byte by byte then
+					if (distance >= length) memcpy(to, from, length);
+					else for (size_t i = 0; i < length; i++) to[i] = from[i];
+					written += length;
+				}
+				if (reader.consumed() > reader.size) fail("PNG_TRUNCATED_DATA");
+			}
+			if (written != outSize) fail("PNG_TRUNCATED_DATA");
+		}
+
+		static uint32_t readBigEndian(const uint8_t* bytes) {
+			return ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16) | ((uint32_t)bytes[2] << 8) | bytes[3];
+		}
+
+		static uint8_t paeth(int a, int b, int c) {
+			int p = a + b - c;
+			int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+			if (pa <= pb && pa <= pc) return (uint8_t)a;
+			return (uint8_t)(pb <= pc ? b : c);
+		}
+
+		Image decode(const uint8_t* data, size_t size) {
+			static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+			if (size < 8 || memcmp(data, signature, 8) != 0) fail("PNG_BAD_SIGNATURE");
+
+			uint32_t width = 0, height = 0;
+			int bitDepth = 0, colorType = -1;
+			uint8_t palette[256][4];
+			int paletteSize = 0;
+			bool hasColorKey = false;
+			uint16_t colorKey[3] = {};
+			std::vector<uint8_t> compressed;
+
+			size_t position = 8;
+			bool ended = false;
+			while (!ended) {
+				if (position + 12 > size) fail("PNG_TRUNCATED_CHUNK");
+				uint32_t length = readBigEndian(data + position);
+				const uint8_t* type = data + position + 4;
+				const uint8_t* chunk = data + position + 8;
+				if (length > size - position - 12) fail("PNG_TRUNCATED_CHUNK");
+				position += 12 + (size_t)length;
+
+				if (memcmp(type, "IHDR", 4) == 0) {
+					if (length != 13) fail("PNG_BAD_HEADER");
+					width = readBigEndian(chunk);
+					height = readBigEndian(chunk + 4);
+					bitDepth = chunk[8];
+					colorType = chunk[9];
+					if (chunk[10] != 0 || chunk[11] != 0) fail("PNG_BAD_HEADER");
+					if (chunk[12] != 0) fail("PNG_INTERLACED_UNSUPPORTED");
+					if (width == 0 || height == 0 || width > 16384 || height > 16384) fail("PNG_BAD_SIZE");
+					bool validDepth = colorType == 0 ? (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8 || bitDepth == 16)
+						: colorType == 3 ? (bitDepth == 1 || bitDepth == 2 || bitDepth == 4 || bitDepth == 8)
+						: (colorType == 2 || colorType == 4 || colorType == 6) && (bitDepth == 8 || bitDepth == 16);
+					if (!validDepth) fail("PNG_UNSUPPORTED_FORMAT");
+				}
+				else if (memcmp(type, "PLTE", 4) == 0) {
+					if (length % 3 != 0 || length > 768) fail("PNG_BAD_PALETTE");
+					paletteSize = (int)length / 3;
+					for (int i = 0; i < paletteSize; i++) {
+						palette[i][0] = chunk[i * 3];
+						palette[i][1] = chunk[i * 3 + 1];
+						palette[i][2] = chunk[i * 3 + 2];
+						palette[i][3] = 255;
+					}
+				}
+				else if (memcmp(type, "tRNS", 4) == 0) {
+					if (colorType == 3) {
+						for (uint32_t i = 0; i < length && i < (uint32_t)paletteSize; i++) palette[i][3] = chunk[i];
+					}
+					else if (colorType == 0 && length >= 2) {
+						hasColorKey = true;
+						colorKey[0] = colorKey[1] = colorKey[2] = (uint16_t)((chunk[0] << 8) | chunk[1]);
+					}
+					else if (colorType == 2 && length >= 6) {
+						hasColorKey = true;
+						for (int i = 0; i < 3; i++) colorKey[i] = (uint16_t)((chunk[i * 2] << 8) | chunk[i * 2 + 1]);
+					}
+				}
+				else if (memcmp(type, "IDAT", 4) == 0) {
+					compressed.insert(compressed.end(), chunk, chunk + length);
+				}
+				else if (memcmp(type, "IEND", 4) == 0) {
+					ended = true;
+				}
+				else if ((type[0] & 0x20) == 0) {
+					// Unknown chunks marked critical cannot be skipped
+					fail("PNG_UNKNOWN_CRITICAL_CHUNK");
+				}
+			}
+			if (colorType < 0) fail("PNG_MISSING_HEADER");
+			if (colorType == 3 && paletteSize == 0) fail("PNG_MISSING_PALETTE");
+
+			static const int channelsOf[7] = { 1, 0, 3, 1, 2, 0, 4 };
+			const int channels = channelsOf[colorType];
+			const size_t bitsPerPixel = (size_t)channels * bitDepth;
+			const size_t stride = (width * bitsPerPixel + 7) / 8;
+			const size_t filterStep = std::max<size_t>(1, bitsPerPixel / 8);
+
+			// Every row is prefixed by its filter type
+			std::vector<uint8_t> raw((stride + 1) * height);
+			inflate(compressed.data(), compressed.size(), raw);
+
+			// Unfilter in place, each row against the reconstructed previous one
+			std::vector<uint8_t> zeroRow(stride, 0);
+			const uint8_t* previous = zeroRow.data();
+			for (uint32_t y = 0; y < height; y++) {
+				uint8_t* row = raw.data() + y * (stride + 1);
+				uint8_t filter = row[0];
+				row++;
+				switch (filter) {
+				case 0:
+					break;
+				case 1:
+					for (size_t i = filterStep; i < stride; i++) row[i] = (uint8_t)(row[i] + row[i - filterStep]);
+					break;
+				case 2:
+					for (size_t i = 0; i < stride; i++) row[i] = (uint8_t)(row[i] + previous[i]);
+					break;
+				case 3:
+					for (size_t i = 0; i < filterStep && i < stride; i++) row[i] = (uint8_t)(row[i] + (previous[i] >> 1));
+					for (size_t i = filterStep; i < stride; i++) row[i] = (uint8_t)(row[i] + ((row[i - filterStep] + previous[i]) >> 1));
+					break;
+				case 4:
+					for (size_t i = 0; i < filterStep && i < stride; i++) row[i] = (uint8_t)(row[i] + previous[i]);
+					for (size_t i = filterStep; i < stride; i++) row[i] = (uint8_t)(row[i] + paeth(row[i - filterStep], previous[i], previous[i - filterStep]));
+					break;
+				default:
+					fail("PNG_BAD_FILTER");
+				}
+				previous = row;
+			}
+
+			Image image;
+			image.width = (int)width;
+			image.height = (int)height;
+			image.pixels.resize((size_t)width * height * 4);
+			uint8_t* out = image.pixels.data();
+			const int sampleBytes = bitDepth == 16 ? 2 : 1;
+			for (uint32_t y = 0; y < height; y++) {
+				const uint8_t* row = raw.data() + y * (stride + 1) + 1;
+				for (uint32_t x = 0; x < width; x++, out += 4) {
+					if (bitDepth < 8) {
+						// Packed from the high bits down
+						size_t bit = (size_t)x * bitDepth;
+						int value = (row[bit / 8] >> (8 - bitDepth - (int)(bit % 8))) & ((1 << bitDepth) - 1);
+						if (colorType == 3) {
+							if (value >= paletteSize) fail("PNG_BAD_PALETTE_INDEX");
+							memcpy(out, palette[value], 4);
+						}
+						else {
+							uint8_t gray = (uint8_t)(value * 255 / ((1 << bitDepth) - 1));
+							out[0] = out[1] = out[2] = gray;
+							out[3] = hasColorKey && value == colorKey[0] ? 0 : 255;
+						}
+						continue;
+					}
+
+					// 8 / 16 bit samples, the high byte comes first
+					const uint8_t* pixel = row + (size_t)x * channels * sampleBytes;
+					auto sample = [&](int channel) { return pixel[channel * sampleBytes]; };
+					auto fullSample = [&](int channel) {
+						return sampleBytes == 2 ? (uint16_t)((pixel[channel * 2] << 8) | pixel[channel * 2 + 1]) : (uint16_t)pixel[channel];
+					};
+					switch (colorType) {
+					case 0:
+						out[0] = out[1] = out[2] = sample(0);
+						out[3] = hasColorKey && fullSample(0) == colorKey[0] ? 0 : 255;
+						break;
+					case 2:
+						out[0] = sample(0);
+						out[1] = sample(1);
+						out[2] = sample(2);
+						out[3] = hasColorKey && fullSample(0) == colorKey[0] && fullSample(1) == colorKey[1] && fullSample(2) == colorKey[2] ? 0 : 255;
+						break;
+					case 3:
+						if (pixel[0] >= paletteSize) fail("PNG_BAD_PALETTE_INDEX");
+						memcpy(out, palette[pixel[0]], 4);
+						break;
+					case 4:
+						out[0] = out[1] = out[2] = sample(0);
+						out[3] = sample(1);
+						break;
+					default:
+						out[0] = sample(0);
+						out[1] = sample(1);
+						out[2] = sample(2);
+						out[3] = sample(3);
+						break;
+					}
+				}
+			}
+			return image;
+		}
+
+		Image load(const std::string& path) {
+			std::ifstream file(path, std::ios::binary | std::ios::ate);
+			if (!file) throw std::runtime_error("ERROR::IMAGE::FILE_NOT_SUCCESSFULLY_READ " + path);
+			std::streamsize size = file.tellg();
+			file.seekg(0);
+			std::vector<uint8_t> bytes((size_t)std::max<std::streamsize>(size, 0));
+			if (!file.read((char*)bytes.data(), size)) throw std::runtime_error("ERROR::IMAGE::FILE_NOT_SUCCESSFULLY_READ " + path);
+			try {
+				return decode(bytes.data(), bytes.size());
+			}
+			catch (std::runtime_error& e) {
+				throw std::runtime_error(std::string(e.what()) + " " + path);
+			}
+		}
+	}
+}
@@ -3,12 +3,15 @@
 
 namespace Engine {
 	namespace Input {
+		SpscQueue<InputEvent> events(1024);
 		bool keyPressedData[GLFW_KEY_LAST] = {};
+		bool keyWentDownData[GLFW_KEY_LAST] = {};
 		bool mouseButtonPressedData[GLFW_MOUSE_BUTTON_LAST] = {};
 		float mouseX = 0.0f;
 		float mouseY = 0.0f;
 		float mouseScrollX = 0.0f;
 		float mouseScrollY = 0.0f;
+		bool keyHeldNowData[GLFW_KEY_LAST] = {};
 
 		// Utility
 		bool isKeyDown(int key) {
@@ -18,6 +21,20 @@ namespace Engine {
 			return false;
 		}
 
+		bool wasKeyPressed(int key) {
+			if (key >= 0 && key < GLFW_KEY_LAST) {
+				return keyWentDownData[key];
+			}
+			return false;
+		}
+
+		bool isKeyHeldNow(int key) {
+			if (key >= 0 && key < GLFW_KEY_LAST) {
+				return keyHeldNowData[key];
+			}
+			return false;
+		}
+
 		bool isMouseButtonDown(int mouseButton) {
 			if (mouseButton >= 0 && mouseButton < GLFW_MOUSE_BUTTON_LAST) {
 				return mouseButtonPressedData[mouseButton];
@@ -25,27 +42,64 @@ namespace Engine {
 			return false;
 		}
 
-		// Callbacks
+		int processEvents(double untilTime) {
+			memset(keyWentDownData, 0, sizeof(keyWentDownData));
+			mouseScrollX = 0.0f;
+			mouseScrollY = 0.0f;
+			int processed = 0;
+			while (const InputEvent* event = events.peek()) {
+				if (event->time > untilTime) break;
+				switch (event->type) {
+				case InputEvent::KEY:
+					// Repeats keep the key down
+					if (event->code >= 0 && event->code < GLFW_KEY_LAST) {
+						keyPressedData[event->code] = event->action != GLFW_RELEASE;
+						if (event->action == GLFW_PRESS) keyWentDownData[event->code] = true;
+					}
+					break;
+				case InputEvent::MOUSE_BUTTON:
+					if (event->code >= 0 && event->code < GLFW_MOUSE_BUTTON_LAST) mouseButtonPressedData[event->code] = event->action != GLFW_RELEASE;
+					break;
+				case InputEvent::MOUSE_MOVE:
+					mouseX = event->x;
+					mouseY = event->y;
+					break;
+				case InputEvent::MOUSE_SCROLL:
+					mouseScrollX += event->x;
+					mouseScrollY += event->y;
+					break;
+				}
+				events.pop();
+				processed++;
+			}
+			return processed;
+		}
+
+		// Callbacks, GLFW runs them inside glfwPollEvents so the timestamps are taken then
+		static void pushEvent(InputEvent::Type type, int action, int mods, int code, float x, float y) {
+			InputEvent event = { type, (uint8_t)action, (uint16_t)mods, code, x, y, glfwGetTime() };
+			events.push(event);
+		}
+
 		void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
 			if (key >= 0 && key < GLFW_KEY_LAST) {
-				keyPressedData[key] = action == GLFW_PRESS;
+				keyHeldNowData[key] = action != GLFW_RELEASE;
+				pushEvent(InputEvent::KEY, action, mods, key, 0.0f, 0.0f);
 			}
 		}
 
 		void mousePosCallback(GLFWwindow* window, double xpos, double ypos) {
-			mouseX = (float)xpos;
-			mouseY = (float)ypos;
+			pushEvent(InputEvent::MOUSE_MOVE, 0, 0, 0, (float)xpos, (float)ypos);
 		}
 
 		void mouseButtonCallback(GLFWwindow* window, int button, int action, int mods) {
 			if (button >= 0 && button < GLFW_MOUSE_BUTTON_LAST) {
-				mouseButtonPressedData[button] = action == GLFW_PRESS;
+				pushEvent(InputEvent::MOUSE_BUTTON, action, mods, button, 0.0f, 0.0f);
 			}
 		}
 
 		void mouseScrollCallback(GLFWwindow* window, double xoffset, double yoffset) {
-			mouseScrollX = (float)xoffset;
-			mouseScrollY = (float)yoffset;
+			pushEvent(InputEvent::MOUSE_SCROLL, 0, 0, 0, (float)xoffset, (float)yoffset);
 		}
 	}
-}
\ No newline at end of file
+}
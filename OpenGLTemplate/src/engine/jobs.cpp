@@ -0,0 +1,187 @@
+#include "engine/jobs.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <thread>
+
+namespace Engine {
+	namespace Jobs {
+		struct QueuedJob {
+			Job job;
+			Counter* counter;
+		};
+
+		struct WorkQueue {
+			std::mutex mutex;
+			std::deque<QueuedJob> jobs;
+		};
+
+		// Queue 0 takes jobs submitted from outside the pool (e.g. the main thread), worker i owns queue i + 1
+		// Only init() writes the vector, before the workers start, after that it is read-only until the next init()
+		static std::vector<std::unique_ptr<WorkQueue>> queues;
+		static std::vector<std::thread> workers;
+		static std::atomic<bool> running(false);
+		static std::atomic<int> queuedJobs(0);
+		static std::mutex sleepMutex;
+		static std::condition_variable sleepCondition;
+		static thread_local int threadQueueIndex = 0;
+
+		void Counter::increment() {
+			if (value.fetch_add(1, std::memory_order_relaxed) != 0) return;
+			// Reused after reaching zero, continuations wait again
+			std::lock_guard<std::mutex> lock(continuationMutex);
+			finished = false;
+		}
+
+		void Counter::decrement() {
+			// Not the last job: lock-free
+			int current = value.load(std::memory_order_relaxed);
+			while (current > 1) {
+				if (value.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel, std::memory_order_relaxed)) return;
+			}
+			// Last job: take the continuations while the count is still 1, then publish zero as the final
+			// write, isDone() may let the owner free the counter right after it
+			std::vector<Job> ready;
+			{
+				std::lock_guard<std::mutex> lock(continuationMutex);
+				ready.swap(continuations);
+				finished = true;
+			}
+			value.fetch_sub(1, std::memory_order_acq_rel);
+			for (Job& job : ready) submit(std::move(job), nullptr);
+		}
+
+		void runJob(const Job& job, Counter* counter) {
+			job();
+			if (counter != nullptr) counter->decrement();
+		}
+
+		// Own queue from the back (LIFO, cache warm), other queues from the front (FIFO, oldest work)
+		static bool tryPopJob(int queueIndex, QueuedJob& out) {
+			{
+				WorkQueue& own = *queues[queueIndex];
+				std::lock_guard<std::mutex> lock(own.mutex);
+				if (!own.jobs.empty()) {
+					out = std::move(own.jobs.back());
+					own.jobs.pop_back();
+					queuedJobs--;
+					return true;
+				}
+			}
+			for (size_t i = 1; i <= queues.size(); i++) {
+				WorkQueue& victim = *queues[(queueIndex + i) % queues.size()];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (!victim.jobs.empty()) {
+					out = std::move(victim.jobs.front());
+					victim.jobs.pop_front();
+					queuedJobs--;
+					return true;
+				}
+			}
+			return false;
+		}
+
+		static void workerLoop(int queueIndex) {
+			threadQueueIndex = queueIndex;
+			QueuedJob queued;
+			while (running) {
+				if (tryPopJob(queueIndex, queued)) {
+					runJob(queued.job, queued.counter);
+					continue;
+				}
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				sleepCondition.wait(lock, [] { return !running || queuedJobs > 0; });
+			}
+		}
+
+		void init(int workerCount) {
+			if (running) return;
+			if (workerCount <= 0) {
+				workerCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+			}
+			queues.clear();
+			for (int i = 0; i <= workerCount; i++) queues.push_back(std::make_unique<WorkQueue>());
+			running.store(true, std::memory_order_release);
+			for (int i = 1; i <= workerCount; i++) workers.emplace_back(workerLoop, i);
+		}
+
+		void shutdown() {
+			{
+				std::lock_guard<std::mutex> lock(sleepMutex);
+				running = false;
+			}
+			sleepCondition.notify_all();
+			for (std::thread& worker : workers) worker.join();
+			workers.clear();
+			// Finish what is still queued on this thread, dropping it would leave its counters above zero
+			// Jobs submitted meanwhile run inline, the queues stay allocated until the next init()
+			QueuedJob queued;
+			while (!queues.empty() && tryPopJob(threadQueueIndex, queued)) {
+				runJob(queued.job, queued.counter);
+			}
+			queuedJobs = 0;
+		}
+
+		int workerCount() {
+			return (int)workers.size();
+		}
+
+		void submit(Job job, Counter* counter) {
+			if (counter != nullptr) counter->increment();
+			// No pool (not initialized or shut down), run inline
+			if (!running.load(std::memory_order_acquire)) {
+				runJob(job, counter);
+				return;
+			}
+			{
+				WorkQueue& queue = *queues[threadQueueIndex];
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				queue.jobs.push_back({ std::move(job), counter });
+				queuedJobs++;
+			}
+			{
+				// Taking the lock orders this with a worker that is about to sleep
+				std::lock_guard<std::mutex> lock(sleepMutex);
+			}
+			sleepCondition.notify_one();
+		}
+
+		void submitAfter(Counter& dependency, Job job, Counter* counter) {
+			// Count the continuation now so waiting on counter also covers jobs not yet submitted
+			if (counter != nullptr) counter->increment();
+			Job continuation = [job = std::move(job), counter]() {
+				runJob(job, counter);
+			};
+			{
+				std::lock_guard<std::mutex> lock(dependency.continuationMutex);
+				if (!dependency.finished && dependency.value.load(std::memory_order_acquire) != 0) {
+					dependency.continuations.push_back(std::move(continuation));
+					return;
+				}
+			}
+			submit(std::move(continuation), nullptr);
+		}
+
+		void parallelFor(int count, int batchSize, const std::function<void(int, int)>& function, Counter* counter) {
+			batchSize = std::max(1, batchSize);
+			for (int begin = 0; begin < count; begin += batchSize) {
+				int end = std::min(count, begin + batchSize);
+				submit([function, begin, end]() { function(begin, end); }, counter);
+			}
+		}
+
+		void wait(Counter& counter) {
+			QueuedJob queued;
+			while (!counter.isDone()) {
+				if (!queues.empty() && tryPopJob(threadQueueIndex, queued)) {
+					runJob(queued.job, queued.counter);
+				}
+				else {
+					std::this_thread::yield();
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,27 @@
+#include "engine/lod.h"
+
+#include <algorithm>
+
+namespace Engine {
+	namespace Lod {
+		float chunkDistance(const glm::vec3& cameraPosition, int chunkX, int chunkZ) {
+			const float chunkSize = (float)Mesher::SECTION_SIZE;
+			glm::vec2 camera = glm::vec2(cameraPosition.x, cameraPosition.z) / chunkSize;
+			glm::vec2 min = glm::vec2((float)chunkX, (float)chunkZ);
+			glm::vec2 nearest = glm::clamp(camera, min, min + glm::vec2(1.0f));
+			return glm::length(camera - nearest);
+		}
+
+		int selectLod(const LodSettings& settings, float distance, int currentLod) {
+			int lod = 0;
+			while (lod < Mesher::MAX_LOD && distance >= settings.startDistance[lod]) lod++;
+			if (currentLod < 0 || lod == currentLod) return lod;
+
+			// Keep the current level unless the distance is clear of the boundary between them
+			int boundary = std::min(lod, currentLod);
+			float margin = std::abs(distance - settings.startDistance[boundary]);
+			if (std::abs(lod - currentLod) == 1 && margin < settings.hysteresis) return currentLod;
+			return lod;
+		}
+	}
+}
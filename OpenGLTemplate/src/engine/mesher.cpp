@@ -0,0 +1,309 @@
+#include "engine/mesher.h"
+
+#include <algorithm>
+
+namespace Engine {
+	namespace Mesher {
+		// Full sky light until lighting is implemented
+		static const int defaultLight = 0xF0;
+
+		// Index offsets of one step along x, y and z in the padded array
+		static const int axisStride[3] = { 1, PADDED_SIZE * PADDED_SIZE, PADDED_SIZE };
+
+		// Ambient occlusion of one face corner, 0 (fully occluded) to 3 (open)
+		static int cornerAO(const BlockId* blocks, int neighbourIndex, int uStep, int vStep) {
+			bool side1 = Blocks::isOpaque(blocks[neighbourIndex + uStep]);
+			bool side2 = Blocks::isOpaque(blocks[neighbourIndex + vStep]);
+			if (side1 && side2) return 0;
+			return 3 - (int)side1 - (int)side2 - (int)Blocks::isOpaque(blocks[neighbourIndex + uStep + vStep]);
+		}
+
+		// Corner AO of a face nothing occludes, all four corners open
+		static const uint32_t openAO = 0xFF;
+
+		// For every cell of one slice, a key identifying the visible face (0 = no face)
+		// key: texture layer + 1 in the low 16 bits, corner AO (4 x 2 bits) above
+		// size is the cells per side actually used (SECTION_SIZE >> lod)
+		static void buildFaceMask(const BlockId* blocks, int size, int face, int slice, uint32_t mask[SECTION_SIZE * SECTION_SIZE]) {
+			const int d = face / 2;
+			const int u = (d + 1) % 3;
+			const int v = (d + 2) % 3;
+			const int normalStep = face % 2 == 0 ? axisStride[d] : -axisStride[d];
+			const int uStep = axisStride[u];
+			const int vStep = axisStride[v];
+
+			int p[3] = { 0, 0, 0 };
+			p[d] = slice;
+			const int sliceIndex = paddedIndex(p[0], p[1], p[2]);
+
+			for (int b = 0; b < size; b++) {
+				int index = sliceIndex + b * vStep;
+				for (int a = 0; a < size; a++, index += uStep) {
+					uint32_t& key = mask[b * SECTION_SIZE + a];
+					key = 0;
+
+					BlockId block = blocks[index];
+					if (!Blocks::isOpaque(block)) continue;
+					int neighbourIndex = index + normalStep;
+					if (Blocks::isOpaque(blocks[neighbourIndex])) continue;
+
+					// Corners in quad order (0,0) (1,0) (1,1) (0,1)
+					uint32_t ao = (uint32_t)cornerAO(blocks, neighbourIndex, -uStep, -vStep)
+						| ((uint32_t)cornerAO(blocks, neighbourIndex, uStep, -vStep) << 2)
+						| ((uint32_t)cornerAO(blocks, neighbourIndex, uStep, vStep) << 4)
+						| ((uint32_t)cornerAO(blocks, neighbourIndex, -uStep, vStep) << 6);
+					key = (uint32_t)(Blocks::textureLayer(block, face) + 1) | (ao << 16);
+				}
+			}
+		}
+
+		// Positions and UVs are multiplied by scale, so textures still tile once per block
+		static void emitQuad(MeshData& mesh, int scale, int face, int slice, int a, int b, int w, int h, uint32_t key) {
+			const int d = face / 2;
+			const int u = (d + 1) % 3;
+			const int v = (d + 2) % 3;
+			const bool positive = face % 2 == 0;
+			const int layer = (int)(key & 0xFFFF) - 1;
+			const int cornerU[4] = { 0, w, w, 0 };
+			const int cornerV[4] = { 0, 0, h, h };
+
+			int ao[4];
+			GLuint base = (GLuint)mesh.vertices.size();
+			for (int i = 0; i < 4; i++) {
+				int p[3];
+				p[d] = (slice + (positive ? 1 : 0)) * scale;
+				p[u] = (a + cornerU[i]) * scale;
+				p[v] = (b + cornerV[i]) * scale;
+				ao[i] = (key >> (16 + i * 2)) & 3;
+				mesh.vertices.push_back(PackedVertex::pack(p[0], p[1], p[2], face, ao[i], cornerU[i] * scale, cornerV[i] * scale, layer, defaultLight));
+			}
+
+			// (u, v) is right handed around the axis, so positive faces are counter-clockwise as emitted
+			// Flip the diagonal when needed so AO interpolates symmetrically
+			GLuint quad[6];
+			if (ao[0] + ao[2] >= ao[1] + ao[3]) {
+				GLuint order[6] = { 0, 1, 2, 2, 3, 0 };
+				memcpy(quad, order, sizeof(quad));
+			}
+			else {
+				GLuint order[6] = { 0, 1, 3, 1, 2, 3 };
+				memcpy(quad, order, sizeof(quad));
+			}
+			if (!positive) {
+				std::swap(quad[1], quad[2]);
+				std::swap(quad[4], quad[5]);
+			}
+			for (GLuint index : quad) mesh.indices.push_back(base + index);
+		}
+
+		// indexOf maps section coordinates to the layout of blocks (paddedIndex or lodPaddedIndex)
+		static FaceConnectivity floodConnectivity(const BlockId* blocks, int (*indexOf)(int, int, int)) {
+			const int volume = SECTION_SIZE * SECTION_SIZE * SECTION_SIZE;
+			// Cells are indexed (y * 16 + z) * 16 + x, same as ChunkSection
+			const int cellStride[3] = { 1, SECTION_SIZE * SECTION_SIZE, SECTION_SIZE };
+			bool visited[volume];
+			int stack[volume];
+			int openCells = 0;
+			for (int y = 0; y < SECTION_SIZE; y++) {
+				for (int z = 0; z < SECTION_SIZE; z++) {
+					int index = indexOf(0, y, z);
+					for (int x = 0; x < SECTION_SIZE; x++, index++) {
+						bool opaque = Blocks::isOpaque(blocks[index]);
+						visited[(y * SECTION_SIZE + z) * SECTION_SIZE + x] = opaque;
+						openCells += opaque ? 0 : 1;
+					}
+				}
+			}
+			if (openCells == 0) return 0;
+			if (openCells == volume) return ALL_FACES_CONNECTED;
+
+			FaceConnectivity connectivity = 0;
+			for (int seed = 0; seed < volume; seed++) {
+				if (visited[seed]) continue;
+
+				// Collect the faces this region of open blocks touches
+				uint32_t faces = 0;
+				int stackSize = 0;
+				stack[stackSize++] = seed;
+				visited[seed] = true;
+				while (stackSize > 0) {
+					int cell = stack[--stackSize];
+					int p[3] = { cell % SECTION_SIZE, cell / (SECTION_SIZE * SECTION_SIZE), (cell / SECTION_SIZE) % SECTION_SIZE };
+					for (int d = 0; d < 3; d++) {
+						if (p[d] == SECTION_SIZE - 1) faces |= 1u << (d * 2);
+						else if (!visited[cell + cellStride[d]]) {
+							visited[cell + cellStride[d]] = true;
+							stack[stackSize++] = cell + cellStride[d];
+						}
+						if (p[d] == 0) faces |= 1u << (d * 2 + 1);
+						else if (!visited[cell - cellStride[d]]) {
+							visited[cell - cellStride[d]] = true;
+							stack[stackSize++] = cell - cellStride[d];
+						}
+					}
+				}
+
+				for (int a = 0; a < FACE_COUNT; a++) {
+					if (faces & (1u << a)) connectivity |= (FaceConnectivity)faces << (a * FACE_COUNT);
+				}
+				if (connectivity == ALL_FACES_CONNECTED) break;
+			}
+			return connectivity;
+		}
+
+		FaceConnectivity computeConnectivity(const BlockId* paddedBlocks) {
+			return floodConnectivity(paddedBlocks, paddedIndex);
+		}
+
+		// Emits the keys of one slice mask, merged into rectangles when greedy
+		static void emitMask(MeshData& mesh, int size, int scale, bool greedy, int face, int slice, uint32_t mask[SECTION_SIZE * SECTION_SIZE]) {
+			for (int b = 0; b < size; b++) {
+				for (int a = 0; a < size;) {
+					uint32_t key = mask[b * SECTION_SIZE + a];
+					if (key == 0 || !greedy) {
+						if (key != 0) emitQuad(mesh, scale, face, slice, a, b, 1, 1, key);
+						a++;
+						continue;
+					}
+
+					// Grow along u, then along v while the whole row matches
+					int w = 1;
+					while (a + w < size && mask[b * SECTION_SIZE + a + w] == key) w++;
+					int h = 1;
+					for (; b + h < size; h++) {
+						bool rowMatches = true;
+						for (int k = 0; k < w; k++) {
+							if (mask[(b + h) * SECTION_SIZE + a + k] != key) {
+								rowMatches = false;
+								break;
+							}
+						}
+						if (!rowMatches) break;
+					}
+
+					emitQuad(mesh, scale, face, slice, a, b, w, h, key);
+					for (int j = 0; j < h; j++) {
+						for (int k = 0; k < w; k++) mask[(b + j) * SECTION_SIZE + a + k] = 0;
+					}
+					a += w;
+				}
+			}
+		}
+
+		static void meshSlices(const BlockId* blocks, int lod, bool greedy, MeshData& mesh) {
+			const int size = SECTION_SIZE >> lod;
+			const int scale = 1 << lod;
+			uint32_t mask[SECTION_SIZE * SECTION_SIZE];
+			for (int face = 0; face < FACE_COUNT; face++) {
+				for (int slice = 0; slice < size; slice++) {
+					buildFaceMask(blocks, size, face, slice, mask);
+					emitMask(mesh, size, scale, greedy, face, slice, mask);
+				}
+			}
+		}
+
+		// On each x / z border slice, walk down from every surface edge (an opaque border cell under a
+		// non-opaque one) for SKIRT_DEPTH blocks and close the border faces the padding culled. The walk
+		// stops at the first non-opaque cell, faces that are visible anyway come from the normal slices
+		static void meshSkirts(const BlockId* blocks, int lod, MeshData& mesh) {
+			const int size = SECTION_SIZE >> lod;
+			const int scale = 1 << lod;
+			const int depthCells = std::max(1, SKIRT_DEPTH / scale);
+			const int borderFaces[4] = { FACE_POS_X, FACE_NEG_X, FACE_POS_Z, FACE_NEG_Z };
+			uint32_t mask[SECTION_SIZE * SECTION_SIZE];
+			for (int face : borderFaces) {
+				const int d = face / 2;
+				const int u = (d + 1) % 3;
+				const int v = (d + 2) % 3;
+				const int along = d == 0 ? 2 : 0;
+				const int slice = face % 2 == 0 ? size - 1 : 0;
+				const int normalStep = face % 2 == 0 ? axisStride[d] : -axisStride[d];
+
+				bool any = false;
+				memset(mask, 0, sizeof(mask));
+				for (int t = 0; t < size; t++) {
+					int p[3];
+					p[d] = slice;
+					p[along] = t;
+					for (int top = size - 1; top >= 0; top--) {
+						const int topIndex = paddedIndex(p[0], top, p[2]);
+						if (!Blocks::isOpaque(blocks[topIndex]) || Blocks::isOpaque(blocks[topIndex + axisStride[1]])) continue;
+						for (int y = top; y >= 0 && top - y < depthCells; y--) {
+							const int index = topIndex - (top - y) * axisStride[1];
+							if (!Blocks::isOpaque(blocks[index])) break;
+							if (!Blocks::isOpaque(blocks[index + normalStep])) continue;
+							p[1] = y;
+							mask[p[v] * SECTION_SIZE + p[u]] = (uint32_t)(Blocks::textureLayer(blocks[index], face) + 1) | (openAO << 16);
+							any = true;
+						}
+					}
+				}
+				if (any) emitMask(mesh, size, scale, true, face, slice, mask);
+			}
+		}
+
+		void meshNaive(const BlockId* paddedBlocks, MeshData& mesh) {
+			mesh.clear();
+			meshSlices(paddedBlocks, 0, false, mesh);
+			mesh.connectivity = computeConnectivity(paddedBlocks);
+		}
+
+		void meshGreedy(const BlockId* paddedBlocks, MeshData& mesh) {
+			mesh.clear();
+			meshSlices(paddedBlocks, 0, true, mesh);
+			meshSkirts(paddedBlocks, 0, mesh);
+			mesh.connectivity = computeConnectivity(paddedBlocks);
+		}
+
+		void downsample(const BlockId* lodPaddedBlocks, int lod, BlockId* coarseBlocks) {
+			const int size = SECTION_SIZE >> lod;
+			const int scale = 1 << lod;
+			std::fill(coarseBlocks, coarseBlocks + PADDED_VOLUME, Blocks::AIR);
+
+			// Cells past the border cover a whole cell of the neighbouring section, exactly the blocks
+			// that section builds its own border cell from
+			int first[PADDED_SIZE];
+			for (int c = -1; c <= size; c++) first[c + 1] = c * scale;
+
+			int counts[Blocks::COUNT];
+			for (int cy = -1; cy <= size; cy++) {
+				for (int cz = -1; cz <= size; cz++) {
+					for (int cx = -1; cx <= size; cx++) {
+						// Solid when at least half the cell is, using its most common opaque block
+						memset(counts, 0, sizeof(counts));
+						int opaque = 0, total = 0;
+						for (int y = first[cy + 1]; y < first[cy + 1] + scale; y++) {
+							for (int z = first[cz + 1]; z < first[cz + 1] + scale; z++) {
+								int index = lodPaddedIndex(first[cx + 1], y, z);
+								for (int x = first[cx + 1]; x < first[cx + 1] + scale; x++, index++) {
+									BlockId block = lodPaddedBlocks[index];
+									total++;
+									if (!Blocks::isOpaque(block)) continue;
+									opaque++;
+									if (block < Blocks::COUNT) counts[block]++;
+								}
+							}
+						}
+						if (opaque * 2 < total) continue;
+
+						BlockId best = Blocks::STONE;
+						for (int block = 0; block < Blocks::COUNT; block++) {
+							if (counts[block] > counts[best]) best = (BlockId)block;
+						}
+						coarseBlocks[paddedIndex(cx, cy, cz)] = best;
+					}
+				}
+			}
+		}
+
+		void meshGreedyLod(const BlockId* lodPaddedBlocks, int lod, MeshData& mesh) {
+			BlockId coarseBlocks[PADDED_VOLUME];
+			downsample(lodPaddedBlocks, lod, coarseBlocks);
+			mesh.clear();
+			meshSlices(coarseBlocks, lod, true, mesh);
+			meshSkirts(coarseBlocks, lod, mesh);
+			// From the full resolution blocks, a passage narrower than a coarse cell still connects faces
+			mesh.connectivity = floodConnectivity(lodPaddedBlocks, lodPaddedIndex);
+		}
+	}
+}
@@ -0,0 +1,38 @@
+#include "engine/noise.h"
+#include "engine/noiseKernel.h"
+
+namespace Engine {
+	namespace Noise {
+		namespace Detail {
+			void fbm2DScalar(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out) {
+				fbm2DGrid<ScalarLanes>(settings, originX, originZ, step, width, depth, out);
+			}
+
+			void fbm3DScalar(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out) {
+				fbm3DGrid<ScalarLanes>(settings, originX, originY, originZ, step, width, height, depth, out);
+			}
+		}
+
+		void fbm2D(Isa isa, const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out) {
+			if (!Cpu::isSupported(isa)) isa = Cpu::bestIsa();
+			switch (isa) {
+#ifdef ENGINE_CPU_X86
+			case Isa::AVX2: Detail::fbm2DAvx2(settings, originX, originZ, step, width, depth, out); break;
+			case Isa::SSE41: Detail::fbm2DSse41(settings, originX, originZ, step, width, depth, out); break;
+#endif
+			default: Detail::fbm2DScalar(settings, originX, originZ, step, width, depth, out); break;
+			}
+		}
+
+		void fbm3D(Isa isa, const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out) {
+			if (!Cpu::isSupported(isa)) isa = Cpu::bestIsa();
+			switch (isa) {
+#ifdef ENGINE_CPU_X86
+			case Isa::AVX2: Detail::fbm3DAvx2(settings, originX, originY, originZ, step, width, height, depth, out); break;
+			case Isa::SSE41: Detail::fbm3DSse41(settings, originX, originY, originZ, step, width, height, depth, out); break;
+#endif
+			default: Detail::fbm3DScalar(settings, originX, originY, originZ, step, width, height, depth, out); break;
+			}
+		}
+	}
+}
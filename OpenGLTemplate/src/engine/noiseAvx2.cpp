@@ -0,0 +1,62 @@
+// Built with AVX2 enabled (see CMakeLists.txt), only called after a CPU check
+// FMA is deliberately left off so results match the scalar and SSE paths bit for bit
+#include "engine/noiseKernel.h"
+#ifdef ENGINE_CPU_X86
+
+#include <immintrin.h>
+
+namespace Engine {
+	namespace Noise {
+		namespace {
+			struct AvxLanes {
+				static const int WIDTH = 8;
+				typedef __m256 F;
+				typedef __m256i I;
+				typedef __m256 M;
+
+				static F set(float v) { return _mm256_set1_ps(v); }
+				static I seti(uint32_t v) { return _mm256_set1_epi32((int)v); }
+				static F iota() { return _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+				static void store(float* p, F v) { _mm256_storeu_ps(p, v); }
+
+				static F add(F a, F b) { return _mm256_add_ps(a, b); }
+				static F sub(F a, F b) { return _mm256_sub_ps(a, b); }
+				static F mul(F a, F b) { return _mm256_mul_ps(a, b); }
+				static F div(F a, F b) { return _mm256_div_ps(a, b); }
+				static F neg(F a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+				static F floor(F a) { return _mm256_floor_ps(a); }
+				static I toInt(F a) { return _mm256_cvttps_epi32(a); }
+				static F toFloat(I a) { return _mm256_cvtepi32_ps(a); }
+
+				static I addi(I a, I b) { return _mm256_add_epi32(a, b); }
+				static I muli(I a, I b) { return _mm256_mullo_epi32(a, b); }
+				static I xori(I a, I b) { return _mm256_xor_si256(a, b); }
+				static I andi(I a, I b) { return _mm256_and_si256(a, b); }
+				template <int N> static I srli(I a) { return _mm256_srli_epi32(a, N); }
+
+				static M gt(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+				static M ge(F a, F b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+				static M bitSet(I a, uint32_t bit) {
+					I b = seti(bit);
+					return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(a, b), b));
+				}
+				static M lessThan(I a, uint32_t v) { return _mm256_castsi256_ps(_mm256_cmpgt_epi32(seti(v), a)); }
+				static M equal(I a, uint32_t v) { return _mm256_castsi256_ps(_mm256_cmpeq_epi32(a, seti(v))); }
+				static M orM(M a, M b) { return _mm256_or_ps(a, b); }
+				static M andM(M a, M b) { return _mm256_and_ps(a, b); }
+				static F select(M m, F a, F b) { return _mm256_blendv_ps(b, a, m); }
+			};
+		}
+
+		namespace Detail {
+			void fbm2DAvx2(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out) {
+				fbm2DGrid<AvxLanes>(settings, originX, originZ, step, width, depth, out);
+			}
+
+			void fbm3DAvx2(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out) {
+				fbm3DGrid<AvxLanes>(settings, originX, originY, originZ, step, width, height, depth, out);
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,61 @@
+// Built with SSE4.1 enabled (see CMakeLists.txt), only called after a CPU check
+#include "engine/noiseKernel.h"
+#ifdef ENGINE_CPU_X86
+
+#include <smmintrin.h>
+
+namespace Engine {
+	namespace Noise {
+		namespace {
+			struct SseLanes {
+				static const int WIDTH = 4;
+				typedef __m128 F;
+				typedef __m128i I;
+				typedef __m128 M;
+
+				static F set(float v) { return _mm_set1_ps(v); }
+				static I seti(uint32_t v) { return _mm_set1_epi32((int)v); }
+				static F iota() { return _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f); }
+				static void store(float* p, F v) { _mm_storeu_ps(p, v); }
+
+				static F add(F a, F b) { return _mm_add_ps(a, b); }
+				static F sub(F a, F b) { return _mm_sub_ps(a, b); }
+				static F mul(F a, F b) { return _mm_mul_ps(a, b); }
+				static F div(F a, F b) { return _mm_div_ps(a, b); }
+				static F neg(F a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+				static F floor(F a) { return _mm_floor_ps(a); }
+				static I toInt(F a) { return _mm_cvttps_epi32(a); }
+				static F toFloat(I a) { return _mm_cvtepi32_ps(a); }
+
+				static I addi(I a, I b) { return _mm_add_epi32(a, b); }
+				static I muli(I a, I b) { return _mm_mullo_epi32(a, b); }
+				static I xori(I a, I b) { return _mm_xor_si128(a, b); }
+				static I andi(I a, I b) { return _mm_and_si128(a, b); }
+				template <int N> static I srli(I a) { return _mm_srli_epi32(a, N); }
+
+				static M gt(F a, F b) { return _mm_cmpgt_ps(a, b); }
+				static M ge(F a, F b) { return _mm_cmpge_ps(a, b); }
+				static M bitSet(I a, uint32_t bit) {
+					I b = seti(bit);
+					return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(a, b), b));
+				}
+				static M lessThan(I a, uint32_t v) { return _mm_castsi128_ps(_mm_cmplt_epi32(a, seti(v))); }
+				static M equal(I a, uint32_t v) { return _mm_castsi128_ps(_mm_cmpeq_epi32(a, seti(v))); }
+				static M orM(M a, M b) { return _mm_or_ps(a, b); }
+				static M andM(M a, M b) { return _mm_and_ps(a, b); }
+				static F select(M m, F a, F b) { return _mm_blendv_ps(b, a, m); }
+			};
+		}
+
+		namespace Detail {
+			void fbm2DSse41(const FbmSettings& settings, float originX, float originZ, float step, int width, int depth, float* out) {
+				fbm2DGrid<SseLanes>(settings, originX, originZ, step, width, depth, out);
+			}
+
+			void fbm3DSse41(const FbmSettings& settings, float originX, float originY, float originZ, float step, int width, int height, int depth, float* out) {
+				fbm3DGrid<SseLanes>(settings, originX, originY, originZ, step, width, height, depth, out);
+			}
+		}
+	}
+}
+#endif
@@ -0,0 +1,361 @@
+#include "engine/profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace Engine {
+	namespace Profiler {
+		namespace Detail {
+			std::atomic<bool> enabled(false);
+		}
+
+		// Trace thread id of the GPU timeline
+		static const uint32_t gpuThread = 1000;
+
+		struct CpuEvent {
+			const char* name;
+			uint64_t start;		// ns since epoch
+			uint64_t end;
+			uint32_t depth;
+			uint32_t thread;
+		};
+
+		struct GpuEvent {
+			const char* name;
+			uint64_t start;		// ns on the CPU timeline
+			uint64_t end;
+			uint32_t depth;
+		};
+
+		// Open scopes are private to the thread, finished events are shared with endFrame, so the
+		// mutex is only contended once per frame when collecting
+		struct ThreadBuffer {
+			uint32_t thread;
+			std::vector<CpuEvent> openScopes;
+			std::mutex mutex;
+			std::vector<CpuEvent> events;
+		};
+
+		struct GpuRecord {
+			const char* name;
+			uint32_t depth;
+			GLuint beginQuery;
+			GLuint endQuery;
+		};
+
+		struct GpuFrame {
+			uint64_t frame = 0;
+			std::vector<GpuRecord> records;
+			GLuint lastQuery = 0;	// Queries complete in order, this one being available means all are
+		};
+
+		struct FrameEvents {
+			uint64_t frame;
+			uint64_t start;
+			uint64_t end;
+			std::vector<CpuEvent> cpuEvents;
+			std::vector<GpuEvent> gpuEvents;
+			RenderState::Counters stateCalls;
+		};
+
+		static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+		static std::mutex registryMutex;
+		static std::vector<std::unique_ptr<ThreadBuffer>> threadBuffers;
+		static thread_local ThreadBuffer* localBuffer = nullptr;
+
+		// GL thread state
+		static uint64_t frameIndex = 0;
+		static uint64_t frameStart = 0;
+		static uint32_t frameThread = 0;
+		static FrameReport report = {};
+		static std::deque<FrameEvents> history;
+		static std::vector<GLuint> freeQueries;
+		static std::vector<GLuint> allQueries;
+		static GpuFrame currentGpuFrame;
+		static std::vector<size_t> openGpuScopes;
+		static std::deque<GpuFrame> pendingGpuFrames;
+		static bool calibrated = false;
+		static int64_t gpuToCpuOffset = 0;
+
+		static uint64_t nowNs() {
+			return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+		}
+
+		static ThreadBuffer& threadBuffer() {
+			if (localBuffer == nullptr) {
+				std::lock_guard<std::mutex> lock(registryMutex);
+				threadBuffers.emplace_back(new ThreadBuffer());
+				localBuffer = threadBuffers.back().get();
+				localBuffer->thread = (uint32_t)threadBuffers.size() - 1;
+			}
+			return *localBuffer;
+		}
+
+		void setEnabled(bool enabled) {
+			Detail::enabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		bool isEnabled() {
+			return Detail::enabled.load(std::memory_order_relaxed);
+		}
+
+		void beginCpuScope(const char* name) {
+			ThreadBuffer& buffer = threadBuffer();
+			buffer.openScopes.push_back({ name, nowNs(), 0, (uint32_t)buffer.openScopes.size(), buffer.thread });
+		}
+
+		void endCpuScope() {
+			uint64_t end = nowNs();
+			ThreadBuffer& buffer = threadBuffer();
+			if (buffer.openScopes.empty()) return;
+			CpuEvent event = buffer.openScopes.back();
+			buffer.openScopes.pop_back();
+			event.end = end;
+			std::lock_guard<std::mutex> lock(buffer.mutex);
+			buffer.events.push_back(event);
+		}
+
+		static GLuint acquireQuery() {
+			if (freeQueries.empty()) {
+				GLuint query;
+				glCreateQueries(GL_TIMESTAMP, 1, &query);
+				allQueries.push_back(query);
+				return query;
+			}
+			GLuint query = freeQueries.back();
+			freeQueries.pop_back();
+			return query;
+		}
+
+		static void releaseQueries(const GpuFrame& gpuFrame) {
+			for (const GpuRecord& record : gpuFrame.records) {
+				freeQueries.push_back(record.beginQuery);
+				freeQueries.push_back(record.endQuery);
+			}
+		}
+
+		void beginGpuScope(const char* name) {
+			if (!calibrated) {
+				// GL timestamps run on their own clock, sample both once to map them onto the CPU timeline
+				GLint64 gpuNow = 0;
+				glGetInteger64v(GL_TIMESTAMP, &gpuNow);
+				gpuToCpuOffset = (int64_t)nowNs() - (int64_t)gpuNow;
+				calibrated = true;
+			}
+			GpuRecord record = { name, (uint32_t)openGpuScopes.size(), acquireQuery(), 0 };
+			glQueryCounter(record.beginQuery, GL_TIMESTAMP);
+			currentGpuFrame.lastQuery = record.beginQuery;
+			openGpuScopes.push_back(currentGpuFrame.records.size());
+			currentGpuFrame.records.push_back(record);
+		}
+
+		void endGpuScope() {
+			if (openGpuScopes.empty()) return;
+			GpuRecord& record = currentGpuFrame.records[openGpuScopes.back()];
+			openGpuScopes.pop_back();
+			record.endQuery = acquireQuery();
+			glQueryCounter(record.endQuery, GL_TIMESTAMP);
+			currentGpuFrame.lastQuery = record.endQuery;
+		}
+
+		// Adds stats to the list, merging with an earlier scope of the same name
+		static void accumulate(std::vector<ScopeStats>& scopes, const char* name, uint32_t depth, double startMs, double ms) {
+			for (ScopeStats& stats : scopes) {
+				if (stats.name == name || strcmp(stats.name, name) == 0) {
+					if (startMs < stats.startMs) {
+						stats.startMs = startMs;
+						stats.depth = depth;
+					}
+					stats.calls++;
+					stats.totalMs += ms;
+					return;
+				}
+			}
+			scopes.push_back({ name, depth, 1, startMs, ms });
+		}
+
+		static void sortByStart(std::vector<ScopeStats>& scopes) {
+			std::sort(scopes.begin(), scopes.end(), [](const ScopeStats& a, const ScopeStats& b) {
+				return a.startMs != b.startMs ? a.startMs < b.startMs : a.depth < b.depth;
+			});
+		}
+
+		static void resolveGpuFrame(const GpuFrame& gpuFrame) {
+			std::vector<GLuint64> times(gpuFrame.records.size() * 2);
+			uint64_t first = UINT64_MAX, last = 0;
+			for (size_t i = 0; i < gpuFrame.records.size(); i++) {
+				glGetQueryObjectui64v(gpuFrame.records[i].beginQuery, GL_QUERY_RESULT, &times[i * 2]);
+				glGetQueryObjectui64v(gpuFrame.records[i].endQuery, GL_QUERY_RESULT, &times[i * 2 + 1]);
+				first = std::min(first, (uint64_t)times[i * 2]);
+				last = std::max(last, (uint64_t)times[i * 2 + 1]);
+			}
+
+			std::vector<GpuEvent> events;
+			report.gpuScopes.clear();
+			for (size_t i = 0; i < gpuFrame.records.size(); i++) {
+				const GpuRecord& record = gpuFrame.records[i];
+				uint64_t begin = times[i * 2], end = std::max(times[i * 2], times[i * 2 + 1]);
+				events.push_back({ record.name, (uint64_t)((int64_t)begin + gpuToCpuOffset), (uint64_t)((int64_t)end + gpuToCpuOffset), record.depth });
+				accumulate(report.gpuScopes, record.name, record.depth, (double)(begin - first) * 1.0e-6, (double)(end - begin) * 1.0e-6);
+			}
+			sortByStart(report.gpuScopes);
+			report.gpuFrame = gpuFrame.frame;
+			report.gpuFrameMs = last > first ? (double)(last - first) * 1.0e-6 : 0.0;
+
+			for (FrameEvents& frame : history) {
+				if (frame.frame == gpuFrame.frame) {
+					frame.gpuEvents.swap(events);
+					break;
+				}
+			}
+		}
+
+		void beginFrame() {
+			frameStart = nowNs();
+		}
+
+		void endFrame() {
+			const bool enabled = isEnabled();
+			if (!enabled && pendingGpuFrames.empty() && currentGpuFrame.records.empty()) return;
+			uint64_t frameEnd = nowNs();
+
+			// Close GPU scopes left open and queue the frame's queries
+			while (!openGpuScopes.empty()) endGpuScope();
+			if (!currentGpuFrame.records.empty()) {
+				currentGpuFrame.frame = frameIndex;
+				pendingGpuFrames.push_back(std::move(currentGpuFrame));
+				currentGpuFrame = GpuFrame();
+			}
+
+			// Collect the CPU scopes every thread finished during the frame, before any GPU results attach to it
+			if (enabled) {
+				FrameEvents frame;
+				frame.frame = frameIndex;
+				frame.start = frameStart != 0 ? frameStart : frameEnd;
+				frame.end = frameEnd;
+				frame.stateCalls = RenderState::getCounters();
+				{
+					std::lock_guard<std::mutex> lock(registryMutex);
+					for (auto& buffer : threadBuffers) {
+						std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+						frame.cpuEvents.insert(frame.cpuEvents.end(), buffer->events.begin(), buffer->events.end());
+						buffer->events.clear();
+					}
+				}
+				frameThread = threadBuffer().thread;
+
+				report.frame = frameIndex;
+				report.frameMs = (double)(frame.end - frame.start) * 1.0e-6;
+				report.stateCalls = frame.stateCalls;
+				report.cpuScopes.clear();
+				for (const CpuEvent& event : frame.cpuEvents) {
+					double startMs = event.start > frame.start ? (double)(event.start - frame.start) * 1.0e-6 : 0.0;
+					accumulate(report.cpuScopes, event.name, event.depth, startMs, (double)(event.end - event.start) * 1.0e-6);
+				}
+				sortByStart(report.cpuScopes);
+
+				history.push_back(std::move(frame));
+				while ((int)history.size() > HISTORY_FRAMES) history.pop_front();
+			}
+
+			// Read back every finished frame without waiting, drop the oldest if the GPU is too far behind
+			while (!pendingGpuFrames.empty()) {
+				GLint available = GL_FALSE;
+				glGetQueryObjectiv(pendingGpuFrames.front().lastQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available) break;
+				resolveGpuFrame(pendingGpuFrames.front());
+				releaseQueries(pendingGpuFrames.front());
+				pendingGpuFrames.pop_front();
+			}
+			while ((int)pendingGpuFrames.size() > MAX_GPU_FRAMES_IN_FLIGHT) {
+				releaseQueries(pendingGpuFrames.front());
+				pendingGpuFrames.pop_front();
+				report.droppedGpuFrames++;
+			}
+			frameIndex++;
+			frameStart = frameEnd;
+		}
+
+		const FrameReport& lastReport() {
+			return report;
+		}
+
+		void printReport() {
+			printf("Frame %llu: %.3f ms | state calls %u issued, %u elided\n", (unsigned long long)report.frame,
+				report.frameMs, report.stateCalls.issued, report.stateCalls.elided);
+			for (const ScopeStats& stats : report.cpuScopes) {
+				printf("  CPU %*s%-*s %8.3f ms (%u)\n", stats.depth * 2, "", 28 - stats.depth * 2, stats.name, stats.totalMs, stats.calls);
+			}
+			if (!report.gpuScopes.empty()) {
+				printf("  GPU frame %llu: %.3f ms, %u frames dropped\n", (unsigned long long)report.gpuFrame, report.gpuFrameMs, report.droppedGpuFrames);
+			}
+			for (const ScopeStats& stats : report.gpuScopes) {
+				printf("  GPU %*s%-*s %8.3f ms (%u)\n", stats.depth * 2, "", 28 - stats.depth * 2, stats.name, stats.totalMs, stats.calls);
+			}
+		}
+
+		static void writeEscaped(FILE* file, const char* text) {
+			for (; *text; text++) {
+				if (*text == '"' || *text == '\\') fputc('\\', file);
+				fputc(*text, file);
+			}
+		}
+
+		// Complete event, times in microseconds
+		static void writeSpan(FILE* file, bool& first, const char* name, const char* category, uint32_t thread, uint64_t start, uint64_t end) {
+			fprintf(file, "%s\n{\"name\":\"", first ? "" : ",");
+			writeEscaped(file, name);
+			fprintf(file, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+				category, thread, start * 1.0e-3, (end > start ? end - start : 0) * 1.0e-3);
+			first = false;
+		}
+
+		bool writeChromeTrace(const std::string& path) {
+			FILE* file = fopen(path.c_str(), "w");
+			if (file == nullptr) return false;
+
+			bool first = true;
+			fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+			size_t threadCount;
+			{
+				std::lock_guard<std::mutex> lock(registryMutex);
+				threadCount = threadBuffers.size();
+			}
+			for (uint32_t thread = 0; thread < threadCount; thread++) {
+				fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s %u\"}}",
+					first ? "" : ",", thread, thread == frameThread ? "Main" : "Worker", thread);
+				first = false;
+			}
+			fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"GPU\"}}", first ? "" : ",", gpuThread);
+			first = false;
+
+			char frameName[32];
+			for (const FrameEvents& frame : history) {
+				snprintf(frameName, sizeof(frameName), "Frame %llu", (unsigned long long)frame.frame);
+				writeSpan(file, first, frameName, "frame", frameThread, frame.start, frame.end);
+				for (const CpuEvent& event : frame.cpuEvents) writeSpan(file, first, event.name, "cpu", event.thread, event.start, event.end);
+				for (const GpuEvent& event : frame.gpuEvents) writeSpan(file, first, event.name, "gpu", gpuThread, event.start, event.end);
+				fprintf(file, ",\n{\"name\":\"State calls\",\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"args\":{\"issued\":%u,\"elided\":%u}}",
+					frame.end * 1.0e-3, frame.stateCalls.issued, frame.stateCalls.elided);
+			}
+			fprintf(file, "\n]}\n");
+			bool ok = ferror(file) == 0;
+			return fclose(file) == 0 && ok;
+		}
+
+		void shutdown() {
+			setEnabled(false);
+			if (!allQueries.empty()) glDeleteQueries((GLsizei)allQueries.size(), allQueries.data());
+			allQueries.clear();
+			freeQueries.clear();
+			pendingGpuFrames.clear();
+			currentGpuFrame = GpuFrame();
+			openGpuScopes.clear();
+			calibrated = false;
+		}
+	}
+}
@@ -0,0 +1,123 @@
+#include "engine/programCache.h"
+#include "engine/renderState.h"
+
+#include <filesystem>
+
+namespace Engine {
+	static const uint32_t cacheMagic = 0x42505247;	// "GRPB"
+	static const size_t headerSize = 3 * sizeof(uint32_t);
+
+	// FNV-1a, 64 bit
+	static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+		const uint8_t* bytes = (const uint8_t*)data;
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 0x100000001B3ull;
+		}
+		return hash;
+	}
+
+	static std::string glString(GLenum name) {
+		const GLubyte* value = glGetString(name);
+		return value ? (const char*)value : "";
+	}
+
+	ProgramCache::ProgramCache(const std::string& directory) : directory(directory) {
+		driverId = glString(GL_VENDOR) + "|" + glString(GL_RENDERER) + "|" + glString(GL_VERSION);
+		GLint formatCount = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+		supported = formatCount > 0;
+
+		// E.g. a read-only install directory: run without a cache rather than fail startup
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error) {
+			std::cout << "ERROR::PROGRAM_CACHE::CREATE_DIRECTORY_FAILED " << directory << ", running without a cache" << std::endl;
+			supported = false;
+		}
+	}
+
+	std::string ProgramCache::pathOf(uint64_t key) const {
+		char name[32];
+		snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+		return (std::filesystem::path(directory) / name).string();
+	}
+
+	uint64_t ProgramCache::makeKey(std::initializer_list<std::string> sources) const {
+		uint64_t hash = 0xCBF29CE484222325ull;
+		for (const std::string& source : sources) {
+			// Length prefix so moving text between two sources changes the key
+			uint64_t length = source.size();
+			hash = hashBytes(hash, &length, sizeof(length));
+			hash = hashBytes(hash, source.data(), source.size());
+		}
+		return hashBytes(hash, driverId.data(), driverId.size());
+	}
+
+	GLuint ProgramCache::load(uint64_t key) {
+		if (!supported) {
+			misses++;
+			return 0;
+		}
+
+		const std::string path = pathOf(key);
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		std::streamoff fileSize = file ? (std::streamoff)file.tellg() : 0;
+		file.seekg(0);
+		uint32_t header[3];
+		// The stored length must match the file, a corrupt entry is a miss and not a huge allocation
+		if (!file || !file.read((char*)header, headerSize) || header[0] != cacheMagic
+			|| header[2] == 0 || (std::streamoff)header[2] != fileSize - (std::streamoff)headerSize) {
+			misses++;
+			return 0;
+		}
+		std::vector<char> binary(header[2]);
+		if (!file.read(binary.data(), binary.size())) {
+			misses++;
+			return 0;
+		}
+		file.close();
+
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header[1], binary.data(), (GLsizei)binary.size());
+		GLint success = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		if (!success) {
+			// Format no longer accepted (driver changed under the same strings), drop the entry
+			glDeleteProgram(program);
+			RenderState::forgetProgram(program);
+			std::error_code error;
+			std::filesystem::remove(path, error);
+			misses++;
+			return 0;
+		}
+		hits++;
+		return program;
+	}
+
+	void ProgramCache::store(uint64_t key, GLuint program) {
+		if (!supported) return;
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0) return;
+		std::vector<char> binary(length);
+		GLenum format = 0;
+		glGetProgramBinary(program, length, &length, &format, binary.data());
+		if (length <= 0) return;
+
+		// Write to a temporary name and rename, so a crash never leaves a truncated entry behind
+		const std::string path = pathOf(key);
+		const std::string tempPath = path + ".tmp";
+		{
+			std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+			uint32_t header[3] = { cacheMagic, (uint32_t)format, (uint32_t)length };
+			file.write((const char*)header, headerSize);
+			file.write(binary.data(), length);
+			if (!file) return;
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error) std::filesystem::remove(tempPath, error);
+	}
+}
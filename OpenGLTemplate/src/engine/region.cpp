@@ -0,0 +1,310 @@
+#include "engine/region.h"
+
+#include <filesystem>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Engine {
+	enum Compression : uint8_t {
+		COMPRESSION_NONE = 0,
+		COMPRESSION_PACKBITS = 1,
+	};
+	static const size_t chunkHeaderSize = 5;
+
+	// PackBits run-length encoding: a control byte c < 128 is followed by c + 1 literal bytes,
+	// c >= 128 repeats the next byte 257 - c times. Palette indices of terrain are long runs
+	static void packBits(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+		size_t i = 0;
+		while (i < size) {
+			size_t run = 1;
+			while (i + run < size && run < 128 && data[i + run] == data[i]) run++;
+			if (run >= 3) {
+				out.push_back((uint8_t)(257 - run));
+				out.push_back(data[i]);
+				i += run;
+				continue;
+			}
+
+			// Literals until the next run of 3 or more
+			size_t start = i;
+			while (i < size && i - start < 128) {
+				if (i + 2 < size && data[i] == data[i + 1] && data[i] == data[i + 2]) break;
+				i++;
+			}
+			out.push_back((uint8_t)(i - start - 1));
+			out.insert(out.end(), data + start, data + i);
+		}
+	}
+
+	static bool unpackBits(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+		out.clear();
+		size_t i = 0;
+		while (i < size) {
+			uint8_t control = data[i++];
+			if (control < 128) {
+				size_t count = (size_t)control + 1;
+				if (size - i < count) return false;
+				out.insert(out.end(), data + i, data + i + count);
+				i += count;
+			}
+			else {
+				if (i >= size) return false;
+				out.insert(out.end(), (size_t)(257 - control), data[i++]);
+			}
+		}
+		return true;
+	}
+
+	static int locationIndex(int localX, int localZ) {
+		return localZ * RegionFile::REGION_SIZE + localX;
+	}
+
+	RegionFile::RegionFile(const std::string& path) :
+		path(path), fileHandle(-1), mappingHandle(0), mapped(nullptr), mappedSize(0), fileSize(0) {
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("ERROR::REGION::OPEN_FAILED " + path);
+		fileHandle = (intptr_t)file;
+		LARGE_INTEGER size;
+		GetFileSizeEx(file, &size);
+		fileSize = (size_t)size.QuadPart;
+#else
+		int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+		if (fd < 0) throw std::runtime_error("ERROR::REGION::OPEN_FAILED " + path);
+		fileHandle = fd;
+		struct stat info;
+		fstat(fd, &info);
+		fileSize = (size_t)info.st_size;
+#endif
+
+		memset(locations, 0, sizeof(locations));
+		if (fileSize < SECTOR_SIZE) {
+			// New (or truncated) file, start with an empty location table
+			writeAt(0, locations, sizeof(locations));
+			fileSize = SECTOR_SIZE;
+		}
+		else {
+			remap();
+			memcpy(locations, mapped, sizeof(locations));
+		}
+
+		// Sectors after the end of a partially written file are dropped
+		usedSectors.assign((fileSize + SECTOR_SIZE - 1) / SECTOR_SIZE, false);
+		usedSectors[0] = true;
+		for (uint32_t& location : locations) {
+			uint32_t first = location >> 8;
+			uint32_t count = location & 0xFF;
+			if (location == 0) continue;
+			if (first == 0 || count == 0 || first + count > usedSectors.size()) {
+				location = 0;
+				continue;
+			}
+			for (uint32_t sector = first; sector < first + count; sector++) usedSectors[sector] = true;
+		}
+	}
+
+	RegionFile::~RegionFile() {
+		unmap();
+#ifdef _WIN32
+		CloseHandle((HANDLE)fileHandle);
+#else
+		close((int)fileHandle);
+#endif
+	}
+
+	void RegionFile::unmap() {
+		if (mapped == nullptr) return;
+#ifdef _WIN32
+		UnmapViewOfFile(mapped);
+		CloseHandle((HANDLE)mappingHandle);
+		mappingHandle = 0;
+#else
+		munmap((void*)mapped, mappedSize);
+#endif
+		mapped = nullptr;
+		mappedSize = 0;
+	}
+
+	// Maps the whole file again, needed once saves have grown it past the current mapping
+	void RegionFile::remap() {
+		unmap();
+#ifdef _WIN32
+		HANDLE mapping = CreateFileMappingA((HANDLE)fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr) throw std::runtime_error("ERROR::REGION::MAP_FAILED " + path);
+		const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (view == nullptr) {
+			CloseHandle(mapping);
+			throw std::runtime_error("ERROR::REGION::MAP_FAILED " + path);
+		}
+		mappingHandle = (intptr_t)mapping;
+#else
+		void* view = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, (int)fileHandle, 0);
+		if (view == MAP_FAILED) throw std::runtime_error("ERROR::REGION::MAP_FAILED " + path);
+#endif
+		mapped = (const uint8_t*)view;
+		mappedSize = fileSize;
+	}
+
+	void RegionFile::writeAt(size_t offset, const void* data, size_t size) {
+#ifdef _WIN32
+		OVERLAPPED overlapped = {};
+		overlapped.Offset = (DWORD)(offset & 0xFFFFFFFF);
+		overlapped.OffsetHigh = (DWORD)((uint64_t)offset >> 32);
+		DWORD written = 0;
+		if (!WriteFile((HANDLE)fileHandle, data, (DWORD)size, &written, &overlapped) || written != size) {
+			throw std::runtime_error("ERROR::REGION::WRITE_FAILED " + path);
+		}
+#else
+		const uint8_t* bytes = (const uint8_t*)data;
+		while (size > 0) {
+			ssize_t written = pwrite((int)fileHandle, bytes, size, (off_t)offset);
+			if (written <= 0) throw std::runtime_error("ERROR::REGION::WRITE_FAILED " + path);
+			bytes += written;
+			offset += (size_t)written;
+			size -= (size_t)written;
+		}
+#endif
+	}
+
+	// First free run, else the end of the file. The chunk's current sectors are still marked used
+	// here, so the new copy never overlaps the one the table points at
+	uint32_t RegionFile::allocateSectors(uint32_t sectorCount) {
+		uint32_t runStart = 1, runLength = 0;
+		for (uint32_t sector = 1; sector < usedSectors.size() && runLength < sectorCount; sector++) {
+			if (usedSectors[sector]) {
+				runStart = sector + 1;
+				runLength = 0;
+			}
+			else {
+				runLength++;
+			}
+		}
+		if (runLength < sectorCount) runStart = (uint32_t)usedSectors.size();
+
+		if (runStart + sectorCount > usedSectors.size()) usedSectors.resize(runStart + sectorCount, false);
+		for (uint32_t sector = runStart; sector < runStart + sectorCount; sector++) usedSectors[sector] = true;
+		return (runStart << 8) | sectorCount;
+	}
+
+	bool RegionFile::hasChunk(int localX, int localZ) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return locations[locationIndex(localX, localZ)] != 0;
+	}
+
+	bool RegionFile::load(int localX, int localZ, Chunk& chunk) {
+		std::lock_guard<std::mutex> lock(mutex);
+		uint32_t location = locations[locationIndex(localX, localZ)];
+		if (location == 0) return false;
+
+		size_t offset = (size_t)(location >> 8) * SECTOR_SIZE;
+		size_t capacity = (size_t)(location & 0xFF) * SECTOR_SIZE;
+		if (offset + capacity > mappedSize) remap();
+
+		const uint8_t* data = mapped + offset;
+		uint32_t payloadSize = 0;
+		memcpy(&payloadSize, data, sizeof(payloadSize));
+		uint8_t compression = data[4];
+		if (payloadSize > capacity - chunkHeaderSize) throw std::runtime_error("ERROR::REGION::CORRUPT_CHUNK " + path);
+
+		bool valid = false;
+		if (compression == COMPRESSION_PACKBITS) {
+			valid = unpackBits(data + chunkHeaderSize, payloadSize, scratch) && chunk.deserialize(scratch.data(), scratch.size());
+		}
+		else if (compression == COMPRESSION_NONE) {
+			valid = chunk.deserialize(data + chunkHeaderSize, payloadSize);
+		}
+		if (!valid) throw std::runtime_error("ERROR::REGION::CORRUPT_CHUNK " + path);
+		return true;
+	}
+
+	void RegionFile::save(int localX, int localZ, const Chunk& chunk) {
+		std::vector<uint8_t> raw;
+		chunk.serialize(raw);
+		std::vector<uint8_t> payload(chunkHeaderSize);
+		packBits(raw.data(), raw.size(), payload);
+		uint8_t compression = COMPRESSION_PACKBITS;
+		if (payload.size() - chunkHeaderSize >= raw.size()) {
+			payload.resize(chunkHeaderSize);
+			payload.insert(payload.end(), raw.begin(), raw.end());
+			compression = COMPRESSION_NONE;
+		}
+
+		uint32_t payloadSize = (uint32_t)(payload.size() - chunkHeaderSize);
+		memcpy(payload.data(), &payloadSize, sizeof(payloadSize));
+		payload[4] = compression;
+		uint32_t sectorCount = (uint32_t)((payload.size() + SECTOR_SIZE - 1) / SECTOR_SIZE);
+		if (sectorCount > MAX_CHUNK_SECTORS) throw std::runtime_error("ERROR::REGION::CHUNK_TOO_LARGE " + path);
+		payload.resize((size_t)sectorCount * SECTOR_SIZE, 0);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		const int index = locationIndex(localX, localZ);
+		const uint32_t previous = locations[index];
+		uint32_t location = allocateSectors(sectorCount);
+		size_t offset = (size_t)(location >> 8) * SECTOR_SIZE;
+		writeAt(offset, payload.data(), payload.size());
+		fileSize = std::max(fileSize, offset + payload.size());
+
+		// The new copy is in place before the table points at it, the old one is released after
+		locations[index] = location;
+		writeAt((size_t)index * sizeof(uint32_t), &location, sizeof(location));
+		if (previous != 0) {
+			for (uint32_t sector = previous >> 8; sector < (previous >> 8) + (previous & 0xFF); sector++) usedSectors[sector] = false;
+		}
+	}
+
+	// RegionStorage
+	static int floorDiv(int value, int divisor) {
+		return value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor);
+	}
+
+	RegionStorage::RegionStorage(const std::string& directory) : directory(directory) {
+		std::filesystem::create_directories(directory);
+	}
+
+	RegionFile& RegionStorage::getRegion(int chunkX, int chunkZ) {
+		int regionX = floorDiv(chunkX, RegionFile::REGION_SIZE);
+		int regionZ = floorDiv(chunkZ, RegionFile::REGION_SIZE);
+		uint64_t key = ((uint64_t)(uint32_t)regionX << 32) | (uint32_t)regionZ;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		std::unique_ptr<RegionFile>& region = regions[key];
+		if (!region) {
+			std::string name = "r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".region";
+			region.reset(new RegionFile((std::filesystem::path(directory) / name).string()));
+		}
+		return *region;
+	}
+
+	bool RegionStorage::load(int chunkX, int chunkZ, Chunk& chunk) {
+		RegionFile& region = getRegion(chunkX, chunkZ);
+		return region.load(chunkX - floorDiv(chunkX, RegionFile::REGION_SIZE) * RegionFile::REGION_SIZE,
+			chunkZ - floorDiv(chunkZ, RegionFile::REGION_SIZE) * RegionFile::REGION_SIZE, chunk);
+	}
+
+	void RegionStorage::save(int chunkX, int chunkZ, const Chunk& chunk) {
+		RegionFile& region = getRegion(chunkX, chunkZ);
+		region.save(chunkX - floorDiv(chunkX, RegionFile::REGION_SIZE) * RegionFile::REGION_SIZE,
+			chunkZ - floorDiv(chunkZ, RegionFile::REGION_SIZE) * RegionFile::REGION_SIZE, chunk);
+	}
+
+	size_t RegionStorage::regionCount() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		return regions.size();
+	}
+
+	size_t RegionStorage::totalFileSize() const {
+		std::lock_guard<std::mutex> lock(mutex);
+		size_t total = 0;
+		for (const auto& region : regions) total += region.second->getFileSize();
+		return total;
+	}
+}
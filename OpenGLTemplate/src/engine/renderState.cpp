@@ -0,0 +1,193 @@
+#include "engine/renderState.h"
+
+namespace Engine {
+	namespace RenderState {
+		// Never a valid GL name or enum, so the first call after invalidate() always reaches GL
+		static const GLuint unknown = 0xFFFFFFFFu;
+
+		enum BufferTarget {
+			TARGET_ARRAY, TARGET_DRAW_INDIRECT, TARGET_DISPATCH_INDIRECT, TARGET_PARAMETER,
+			TARGET_COPY_READ, TARGET_COPY_WRITE, TARGET_PIXEL_PACK, TARGET_PIXEL_UNPACK,
+			TARGET_COUNT
+		};
+
+		enum Capability {
+			CAP_BLEND, CAP_DEPTH_TEST, CAP_CULL_FACE, CAP_SCISSOR_TEST, CAP_STENCIL_TEST,
+			CAP_POLYGON_OFFSET_FILL, CAP_FRAMEBUFFER_SRGB, CAP_PRIMITIVE_RESTART,
+			CAP_COUNT
+		};
+
+		struct Shadow {
+			GLuint program;
+			GLuint vertexArray;
+			GLuint framebuffer;
+			GLuint buffers[TARGET_COUNT];
+			GLuint uniformBases[MAX_BUFFER_BASES];
+			GLuint storageBases[MAX_BUFFER_BASES];
+			GLuint textures[MAX_TEXTURE_UNITS];
+			GLuint capabilities[CAP_COUNT];		// unknown, GL_FALSE or GL_TRUE
+			GLenum blendSource, blendDestination;
+			GLenum depthFunc;
+			GLuint depthMask;
+			GLenum cullFace;
+		};
+
+		static Shadow shadow = [] {
+			Shadow s;
+			memset(&s, 0xFF, sizeof(s));
+			return s;
+		}();
+		static Counters counters = {};
+
+		// True when the value changed and the caller has to issue the GL call
+		template <typename T>
+		static bool update(T& current, T value) {
+			if (current == value) {
+				counters.elided++;
+				return false;
+			}
+			current = value;
+			counters.issued++;
+			return true;
+		}
+
+		static int bufferTargetIndex(GLenum target) {
+			switch (target) {
+			case GL_ARRAY_BUFFER: return TARGET_ARRAY;
+			case GL_DRAW_INDIRECT_BUFFER: return TARGET_DRAW_INDIRECT;
+			case GL_DISPATCH_INDIRECT_BUFFER: return TARGET_DISPATCH_INDIRECT;
+			case GL_PARAMETER_BUFFER: return TARGET_PARAMETER;
+			case GL_COPY_READ_BUFFER: return TARGET_COPY_READ;
+			case GL_COPY_WRITE_BUFFER: return TARGET_COPY_WRITE;
+			case GL_PIXEL_PACK_BUFFER: return TARGET_PIXEL_PACK;
+			case GL_PIXEL_UNPACK_BUFFER: return TARGET_PIXEL_UNPACK;
+			default: return -1;
+			}
+		}
+
+		static int capabilityIndex(GLenum capability) {
+			switch (capability) {
+			case GL_BLEND: return CAP_BLEND;
+			case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+			case GL_CULL_FACE: return CAP_CULL_FACE;
+			case GL_SCISSOR_TEST: return CAP_SCISSOR_TEST;
+			case GL_STENCIL_TEST: return CAP_STENCIL_TEST;
+			case GL_POLYGON_OFFSET_FILL: return CAP_POLYGON_OFFSET_FILL;
+			case GL_FRAMEBUFFER_SRGB: return CAP_FRAMEBUFFER_SRGB;
+			case GL_PRIMITIVE_RESTART: return CAP_PRIMITIVE_RESTART;
+			default: return -1;
+			}
+		}
+
+		void useProgram(GLuint program) {
+			if (update(shadow.program, program)) glUseProgram(program);
+		}
+
+		void bindVertexArray(GLuint vao) {
+			if (update(shadow.vertexArray, vao)) glBindVertexArray(vao);
+		}
+
+		void bindBuffer(GLenum target, GLuint buffer) {
+			int index = bufferTargetIndex(target);
+			if (index < 0) {
+				// Untracked target, always issued
+				counters.issued++;
+				glBindBuffer(target, buffer);
+				return;
+			}
+			if (update(shadow.buffers[index], buffer)) glBindBuffer(target, buffer);
+		}
+
+		void bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+			GLuint* bases = target == GL_UNIFORM_BUFFER ? shadow.uniformBases
+				: target == GL_SHADER_STORAGE_BUFFER ? shadow.storageBases : nullptr;
+			if (bases == nullptr || index >= MAX_BUFFER_BASES) {
+				counters.issued++;
+				glBindBufferBase(target, index, buffer);
+				return;
+			}
+			// Also sets the generic bind point of the target, which is not tracked
+			if (update(bases[index], buffer)) glBindBufferBase(target, index, buffer);
+		}
+
+		void bindTextureUnit(GLuint unit, GLuint texture) {
+			if (unit >= MAX_TEXTURE_UNITS) {
+				counters.issued++;
+				glBindTextureUnit(unit, texture);
+				return;
+			}
+			if (update(shadow.textures[unit], texture)) glBindTextureUnit(unit, texture);
+		}
+
+		void bindFramebuffer(GLuint framebuffer) {
+			if (update(shadow.framebuffer, framebuffer)) glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		}
+
+		void setEnabled(GLenum capability, bool enabled) {
+			int index = capabilityIndex(capability);
+			GLuint value = enabled ? GL_TRUE : GL_FALSE;
+			if (index < 0) counters.issued++;
+			else if (!update(shadow.capabilities[index], value)) return;
+			if (enabled) glEnable(capability);
+			else glDisable(capability);
+		}
+
+		void blendFunc(GLenum source, GLenum destination) {
+			if (shadow.blendSource == source && shadow.blendDestination == destination) {
+				counters.elided++;
+				return;
+			}
+			shadow.blendSource = source;
+			shadow.blendDestination = destination;
+			counters.issued++;
+			glBlendFunc(source, destination);
+		}
+
+		void depthFunc(GLenum func) {
+			if (update(shadow.depthFunc, func)) glDepthFunc(func);
+		}
+
+		void depthMask(bool write) {
+			if (update(shadow.depthMask, (GLuint)(write ? GL_TRUE : GL_FALSE))) glDepthMask(write ? GL_TRUE : GL_FALSE);
+		}
+
+		void cullFace(GLenum face) {
+			if (update(shadow.cullFace, face)) glCullFace(face);
+		}
+
+		// A deleted program stays in use until another is installed, so the shadow becomes unknown rather than 0
+		void forgetProgram(GLuint program) {
+			if (shadow.program == program) shadow.program = unknown;
+		}
+
+		void forgetVertexArray(GLuint vao) {
+			if (shadow.vertexArray == vao) shadow.vertexArray = 0;
+		}
+
+		void forgetBuffer(GLuint buffer) {
+			for (GLuint& bound : shadow.buffers) if (bound == buffer) bound = 0;
+			for (GLuint& bound : shadow.uniformBases) if (bound == buffer) bound = 0;
+			for (GLuint& bound : shadow.storageBases) if (bound == buffer) bound = 0;
+		}
+
+		void forgetTexture(GLuint texture) {
+			for (GLuint& bound : shadow.textures) if (bound == texture) bound = 0;
+		}
+
+		void forgetFramebuffer(GLuint framebuffer) {
+			if (shadow.framebuffer == framebuffer) shadow.framebuffer = 0;
+		}
+
+		void invalidate() {
+			memset(&shadow, 0xFF, sizeof(shadow));
+		}
+
+		const Counters& getCounters() {
+			return counters;
+		}
+
+		void resetCounters() {
+			counters = {};
+		}
+	}
+}
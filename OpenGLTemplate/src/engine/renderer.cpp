@@ -0,0 +1,131 @@
+#include "engine/renderer.h"
+#include "engine/renderState.h"
+
+#include <algorithm>
+
+namespace Engine {
+	static const GLuint vertexBindingIndex = 0;
+	static const GLuint originBindingIndex = 1;
+
+	ChunkRenderer::ChunkRenderer(GLsizeiptr pageSize, int maxDrawsPerFrame)
+		: vaoID(0), vertexArena(pageSize, sizeof(PackedVertex)), indexArena(pageSize / 2, sizeof(GLuint)),
+		streamBuffer(maxDrawsPerFrame * (GLsizeiptr)(sizeof(DrawElementsIndirectCommand) + sizeof(glm::vec3)) + 256),
+		frameStats(), maxDrawsPerFrame(maxDrawsPerFrame), blockTextures(nullptr) {
+		// MeshId 0 is reserved as InvalidMesh
+		meshes.push_back({ 0, 0, 0, false });
+
+		// Vertex buffers are bound per arena page in draw(), the chunk origin is a per-instance
+		// attribute indexed by baseInstance so every command can carry its own origin
+		glCreateVertexArrays(1, &vaoID);
+		Buffers::addIntegerVertexAttrib(vaoID, 0, 2, GL_UNSIGNED_INT, 0, vertexBindingIndex);		// Packed vertex
+		Buffers::addVertexAttrib(vaoID, 2, 3, 0, originBindingIndex);								// Chunk origin
+		glVertexArrayBindingDivisor(vaoID, originBindingIndex, 1);
+	}
+
+	ChunkRenderer::~ChunkRenderer() {
+		glDeleteVertexArrays(1, &vaoID);
+		RenderState::forgetVertexArray(vaoID);
+	}
+
+	ChunkRenderer::MeshId ChunkRenderer::uploadMesh(const PackedVertex* vertices, size_t vertexCount, const GLuint* indices, size_t indexCount) {
+		Mesh mesh;
+		mesh.vertices = vertexArena.allocate(vertexCount * sizeof(PackedVertex));
+		mesh.indices = indexArena.allocate(indexCount * sizeof(GLuint));
+		mesh.indexCount = (GLuint)indexCount;
+		mesh.live = true;
+		vertexArena.upload(mesh.vertices, vertices, vertexCount * sizeof(PackedVertex));
+		indexArena.upload(mesh.indices, indices, indexCount * sizeof(GLuint));
+
+		MeshId id;
+		if (!freeMeshes.empty()) {
+			id = freeMeshes.back();
+			freeMeshes.pop_back();
+			meshes[id] = mesh;
+		}
+		else {
+			id = (MeshId)meshes.size();
+			meshes.push_back(mesh);
+		}
+		return id;
+	}
+
+	void ChunkRenderer::removeMesh(MeshId mesh) {
+		if (mesh == InvalidMesh || mesh >= meshes.size() || !meshes[mesh].live) return;
+		vertexArena.free(meshes[mesh].vertices);
+		indexArena.free(meshes[mesh].indices);
+		meshes[mesh].live = false;
+		freeMeshes.push_back(mesh);
+	}
+
+	void ChunkRenderer::beginFrame() {
+		drawList.clear();
+		frameStats = {};
+	}
+
+	void ChunkRenderer::addDraw(MeshId mesh, const glm::vec3& chunkOrigin) {
+		if (mesh == InvalidMesh || mesh >= meshes.size()) return;
+		const Mesh& m = meshes[mesh];
+		if (!m.live || m.indexCount == 0) return;
+		if ((int)drawList.size() >= maxDrawsPerFrame) {
+			frameStats.drawsDropped++;
+			return;
+		}
+		drawList.push_back({ vertexArena.get(m.vertices).bufferId, indexArena.get(m.indices).bufferId, mesh, chunkOrigin });
+	}
+
+	void ChunkRenderer::draw() {
+		if (drawList.empty()) return;
+
+		// Group draws sharing the same vertex / index pages, usually there is only one group
+		std::sort(drawList.begin(), drawList.end(), [](const DrawRecord& a, const DrawRecord& b) {
+			return a.vertexBufferId != b.vertexBufferId ? a.vertexBufferId < b.vertexBufferId : a.indexBufferId < b.indexBufferId;
+		});
+
+		streamBuffer.beginSegment();
+		RenderState::bindVertexArray(vaoID);
+		RenderState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, streamBuffer.id());
+		if (blockTextures != nullptr) blockTextures->bind();
+
+		size_t groupStart = 0;
+		while (groupStart < drawList.size()) {
+			size_t groupEnd = groupStart;
+			commands.clear();
+			origins.clear();
+			while (groupEnd < drawList.size()
+				&& drawList[groupEnd].vertexBufferId == drawList[groupStart].vertexBufferId
+				&& drawList[groupEnd].indexBufferId == drawList[groupStart].indexBufferId) {
+				const DrawRecord& record = drawList[groupEnd];
+				const Mesh& mesh = meshes[record.mesh];
+				Buffers::Allocation vertexAllocation = vertexArena.get(mesh.vertices);
+				Buffers::Allocation indexAllocation = indexArena.get(mesh.indices);
+
+				DrawElementsIndirectCommand command;
+				command.count = mesh.indexCount;
+				command.instanceCount = 1;
+				command.firstIndex = (GLuint)(indexAllocation.offset / sizeof(GLuint));
+				command.baseVertex = (GLint)(vertexAllocation.offset / sizeof(PackedVertex));
+				command.baseInstance = (GLuint)commands.size();
+				commands.push_back(command);
+				origins.push_back(record.chunkOrigin);
+
+				frameStats.trianglesDrawn += mesh.indexCount / 3;
+				groupEnd++;
+			}
+
+			GLintptr commandOffset = streamBuffer.write(commands.data(), commands.size() * sizeof(DrawElementsIndirectCommand), sizeof(GLuint));
+			GLintptr originOffset = streamBuffer.write(origins.data(), origins.size() * sizeof(glm::vec3), sizeof(float));
+
+			glVertexArrayVertexBuffer(vaoID, vertexBindingIndex, drawList[groupStart].vertexBufferId, 0, sizeof(PackedVertex));
+			glVertexArrayVertexBuffer(vaoID, originBindingIndex, streamBuffer.id(), originOffset, sizeof(glm::vec3));
+			glVertexArrayElementBuffer(vaoID, drawList[groupStart].indexBufferId);
+			glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)commandOffset, (GLsizei)commands.size(), 0);
+
+			frameStats.meshesDrawn += (unsigned int)commands.size();
+			frameStats.multiDrawCalls++;
+			groupStart = groupEnd;
+		}
+
+		// The indirect buffer stays bound, the next frame's bind is then elided
+		streamBuffer.endSegment();
+	}
+}
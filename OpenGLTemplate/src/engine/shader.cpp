@@ -1,155 +1,222 @@
 #include "core.h"
 #include "engine/shader.h"
+#include "engine/uniforms.h"
+#include "engine/programCache.h"
+#include "engine/renderState.h"
 
 namespace Engine {
-	Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath) {
+	Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath, ProgramCache* cache) {
 		// 1. Retrieve the vertex / fragment source code from filePath
-		std::string vertexCode;
-		std::string fragmentCode;
-		std::ifstream vShaderFile;
-		std::ifstream fShaderFile;
-		// Ensure ifstream objects can throw exceptions
-		vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-		fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
+		std::string vertexCode = readSource(vertexPath);
+		std::string fragmentCode = readSource(fragmentPath);
+
+		// 2. Load the linked program from the binary cache, or compile and link it
+		shaderId = 0;
+		uint64_t cacheKey = 0;
+		const bool useCache = cache != nullptr && cache->isSupported();
+		if (useCache) {
+			cacheKey = cache->makeKey({ vertexCode, fragmentCode });
+			shaderId = cache->load(cacheKey);
+		}
+		if (shaderId == 0) {
+			shaderId = compileProgram(vertexCode, fragmentCode, useCache);
+			if (useCache) cache->store(cacheKey, shaderId);
+		}
+
+		introspect();
+	}
+
+	Shader::Shader(GLuint linkedProgram) : shaderId(linkedProgram) {
+		introspect();
+	}
 
+	std::string Shader::readSource(const std::string& path) {
+		std::ifstream file;
+		// Ensure ifstream objects can throw exceptions
+		file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
 		try {
-			// Open files
-			vShaderFile.open(vertexPath);
-			fShaderFile.open(fragmentPath);
-			// Read file's buffer contents into streams
-			std::stringstream vShaderStream, fShaderStream;
-			vShaderStream << vShaderFile.rdbuf();
-			fShaderStream << fShaderFile.rdbuf();
-			// Close file handlers
-			vShaderFile.close();
-			fShaderFile.close();
-			// Convert stream into string
-			vertexCode = vShaderStream.str();
-			fragmentCode = fShaderStream.str();
+			file.open(path);
+			std::stringstream stream;
+			stream << file.rdbuf();
+			file.close();
+			return stream.str();
 		}
 		catch (std::ifstream::failure e) {
-			throw std::exception("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ");
+			throw std::runtime_error("ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ");
 		}
+	}
+
+	void Shader::introspect() {
+		// 3. Get uniform locations, and update the hashmap
+		GLint numUniforms;
+		glGetProgramiv(shaderId, GL_ACTIVE_UNIFORMS, &numUniforms);
+		GLint maxCharLength;
+		glGetProgramiv(shaderId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxCharLength);
 
-		// 2. Compile shaders
+		if (numUniforms > 0 && maxCharLength > 0) {
+			char* charBuffer = new char[maxCharLength];
+			for (int i = 0; i < numUniforms; i++) {
+				int length, size;
+				GLenum dataType;
+				glGetActiveUniform(shaderId, i, maxCharLength, &length, &size, &dataType, charBuffer);
+				GLint varLocation = glGetUniformLocation(shaderId, charBuffer);
+				// Members of uniform blocks have no location
+				if (varLocation < 0) continue;
+				printf("Uniform %s has location %d\n", charBuffer, varLocation);
+				uniforms[charBuffer] = { varLocation, dataType };
+			}
+			delete[] charBuffer;
+		}
+
+		// 4. Share the frame-global block between all programs
+		GLuint frameBlockIndex = glGetUniformBlockIndex(shaderId, "FrameData");
+		if (frameBlockIndex != GL_INVALID_INDEX) {
+			glUniformBlockBinding(shaderId, frameBlockIndex, FRAME_UNIFORM_BINDING);
+		}
+	}
+
+	GLuint Shader::compileProgram(const std::string& vertexCode, const std::string& fragmentCode, bool retrievable) {
+		return finishProgram(beginProgram(vertexCode, fragmentCode, retrievable));
+	}
+
+	// Issues compile and link without querying any status, so a driver with parallel compilation
+	// keeps working in the background until the first status query
+	Shader::PendingProgram Shader::beginProgram(const std::string& vertexCode, const std::string& fragmentCode, bool retrievable) {
 		const char* vShaderCode = vertexCode.c_str();
 		const char* fShaderCode = fragmentCode.c_str();
 
-		unsigned int vertexShaderId, fragmentShaderId;
+		PendingProgram pending;
+		pending.vertexShaderId = glCreateShader(GL_VERTEX_SHADER);				// Create a vertex shader
+		glShaderSource(pending.vertexShaderId, 1, &vShaderCode, NULL);			// Attach the vertex shader source code
+		glCompileShader(pending.vertexShaderId);								// Compile the vertex shader
+
+		pending.fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);			// Create a fragment shader
+		glShaderSource(pending.fragmentShaderId, 1, &fShaderCode, NULL);		// Attach the fragment shader source code
+		glCompileShader(pending.fragmentShaderId);								// Compile the fragment shader
+
+		// Shader program, a failed stage only fails the link, finishProgram reports the stage first
+		pending.programId = glCreateProgram();
+		glAttachShader(pending.programId, pending.vertexShaderId);
+		glAttachShader(pending.programId, pending.fragmentShaderId);
+		// Has to be set before linking for glGetProgramBinary to work everywhere
+		if (retrievable) glProgramParameteri(pending.programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		glLinkProgram(pending.programId);
+		return pending;
+	}
+
+	// Blocks until compilation is done, throws on any error and frees everything on failure
+	GLuint Shader::finishProgram(const PendingProgram& pending) {
 		int success;
 		char infoLog[512];
 
-		// Create vertex shader
-		vertexShaderId = glCreateShader(GL_VERTEX_SHADER);				// Create a vertex shader
-		glShaderSource(vertexShaderId, 1, &vShaderCode, NULL);			// Attach the vertex shader source code
-		glCompileShader(vertexShaderId);								// Compile the vertex shader
 		// Check for vertex shader compile errors
-		glGetShaderiv(vertexShaderId, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(pending.vertexShaderId, GL_COMPILE_STATUS, &success);
 		if (!success) {
-			glGetShaderInfoLog(vertexShaderId, 512, NULL, infoLog);
+			glGetShaderInfoLog(pending.vertexShaderId, 512, NULL, infoLog);
 			std::cout << infoLog << std::endl;
-			glDeleteShader(vertexShaderId);
-			throw std::exception("ERROR::SHADER::VERTEX::COMPILATION_FAILED\n");
+			deletePending(pending);
+			throw std::runtime_error("ERROR::SHADER::VERTEX::COMPILATION_FAILED\n");
 		}
 
-		// Create fragment shader
-		fragmentShaderId = glCreateShader(GL_FRAGMENT_SHADER);			// Create a fragment shader
-		glShaderSource(fragmentShaderId, 1, &fShaderCode, NULL);		// Attach the fragment shader source code
-		glCompileShader(fragmentShaderId);								// Compile the fragment shader
 		// Check for fragment shader compile errors
-		glGetShaderiv(fragmentShaderId, GL_COMPILE_STATUS, &success);
+		glGetShaderiv(pending.fragmentShaderId, GL_COMPILE_STATUS, &success);
 		if (!success) {
-			glGetShaderInfoLog(fragmentShaderId, 512, NULL, infoLog);
+			glGetShaderInfoLog(pending.fragmentShaderId, 512, NULL, infoLog);
 			std::cout << infoLog << std::endl;
-			glDeleteShader(vertexShaderId);
-			glDeleteShader(fragmentShaderId);
-			throw std::exception("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n");
+			deletePending(pending);
+			throw std::runtime_error("ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n");
 		}
 
-		// Shader program
-		shaderId = glCreateProgram();
-		glAttachShader(shaderId, vertexShaderId);
-		glAttachShader(shaderId, fragmentShaderId);
-		glLinkProgram(shaderId);
 		// Check for shader program linking errors
-		glGetProgramiv(shaderId, GL_LINK_STATUS, &success);
+		glGetProgramiv(pending.programId, GL_LINK_STATUS, &success);
 		if (!success) {
-			glGetProgramInfoLog(shaderId, 512, NULL, infoLog);
+			glGetProgramInfoLog(pending.programId, 512, NULL, infoLog);
 			std::cout << infoLog << std::endl;
-			glDeleteShader(vertexShaderId);
-			glDeleteShader(fragmentShaderId);
-			glDeleteProgram(shaderId);
-			throw std::exception("ERROR::PROGRAM::LINKING_FAILED\n");
+			deletePending(pending);
+			throw std::runtime_error("ERROR::PROGRAM::LINKING_FAILED\n");
 		}
 
 		// Delete vertex and fragment shader instances as they have been linked
-		glDetachShader(shaderId, vertexShaderId);
-		glDetachShader(shaderId, fragmentShaderId);
-		glDeleteShader(vertexShaderId);
-		glDeleteShader(fragmentShaderId);
-
-		// 3. Get uniform locations, and update the hashmap
-		GLint numUniforms;
-		glGetProgramiv(shaderId, GL_ACTIVE_UNIFORMS, &numUniforms);
-		GLint maxCharLength;
-		glGetProgramiv(shaderId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxCharLength);
+		glDetachShader(pending.programId, pending.vertexShaderId);
+		glDetachShader(pending.programId, pending.fragmentShaderId);
+		glDeleteShader(pending.vertexShaderId);
+		glDeleteShader(pending.fragmentShaderId);
+		return pending.programId;
+	}
 
-		if (numUniforms > 0 && maxCharLength > 0) {
-			char* charBuffer = new char[maxCharLength];
-			for (int i = 0; i < numUniforms; i++) {
-				int length, size;
-				GLenum dataType;
-				glGetActiveUniform(shaderId, i, maxCharLength, &length, &size, &dataType, charBuffer);
-				GLint varLocation = glGetUniformLocation(shaderId, charBuffer);
-				printf("Uniform %s has location %d\n", charBuffer, varLocation);
-				uniformLocations[charBuffer] = varLocation;
-			}
-			delete[] charBuffer;
-		}
+	void Shader::deletePending(const PendingProgram& pending) {
+		glDeleteShader(pending.vertexShaderId);
+		glDeleteShader(pending.fragmentShaderId);
+		glDeleteProgram(pending.programId);
+		RenderState::forgetProgram(pending.programId);
 	}
 
 	// Use / Activate the shader
 	void Shader::use() {
-		glUseProgram(shaderId);
+		RenderState::useProgram(shaderId);
+	}
+
+	const Shader::UniformInfo* Shader::findUniform(const std::string& name) const {
+		auto it = uniforms.find(name);
+		return it == uniforms.end() ? nullptr : &it->second;
+	}
+
+	// Samplers and images are set with glProgramUniform1i like ints
+	bool Shader::isOpaqueType(GLenum type) {
+		switch (type) {
+		case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER: case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+		case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+		case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+		case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+		case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+		case GL_IMAGE_1D: case GL_IMAGE_2D: case GL_IMAGE_3D: case GL_IMAGE_CUBE: case GL_IMAGE_2D_RECT: case GL_IMAGE_BUFFER:
+		case GL_IMAGE_1D_ARRAY: case GL_IMAGE_2D_ARRAY: case GL_IMAGE_CUBE_MAP_ARRAY: case GL_IMAGE_2D_MULTISAMPLE: case GL_IMAGE_2D_MULTISAMPLE_ARRAY:
+		case GL_INT_IMAGE_1D: case GL_INT_IMAGE_2D: case GL_INT_IMAGE_3D: case GL_INT_IMAGE_CUBE: case GL_INT_IMAGE_2D_RECT: case GL_INT_IMAGE_BUFFER:
+		case GL_INT_IMAGE_1D_ARRAY: case GL_INT_IMAGE_2D_ARRAY: case GL_INT_IMAGE_CUBE_MAP_ARRAY: case GL_INT_IMAGE_2D_MULTISAMPLE: case GL_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+		case GL_UNSIGNED_INT_IMAGE_1D: case GL_UNSIGNED_INT_IMAGE_2D: case GL_UNSIGNED_INT_IMAGE_3D: case GL_UNSIGNED_INT_IMAGE_CUBE: case GL_UNSIGNED_INT_IMAGE_2D_RECT: case GL_UNSIGNED_INT_IMAGE_BUFFER:
+		case GL_UNSIGNED_INT_IMAGE_1D_ARRAY: case GL_UNSIGNED_INT_IMAGE_2D_ARRAY: case GL_UNSIGNED_INT_IMAGE_CUBE_MAP_ARRAY: case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE: case GL_UNSIGNED_INT_IMAGE_2D_MULTISAMPLE_ARRAY:
+			return true;
+		default:
+			return false;
+		}
 	}
 
+	// Missing names and type mismatches set location -1, which GL ignores, like plain glUniform* on a wrong name
 	void Shader::setBool(const std::string& name, const bool value) {
-		use();
-		glUniform1i(uniformLocations[name], (int)value);
+		set(resolveUniform<bool>(name, false), value);
 	}
 
 	void Shader::setInt(const std::string& name, const int value) {
-		use();
-		glUniform1i(uniformLocations[name], value);
+		set(resolveUniform<int>(name, false), value);
 	}
 
 	void Shader::setFloat(const std::string& name, const float value) {
-		use();
-		glUniform1f(uniformLocations[name], value);
+		set(resolveUniform<float>(name, false), value);
 	}
 
 	void Shader::setMat3(const std::string& name, const glm::mat3 mat) {
-		use();
-		glUniformMatrix3fv(uniformLocations[name], 1, GL_FALSE, glm::value_ptr(mat));
+		set(resolveUniform<glm::mat3>(name, false), mat);
 	}
 
 	void Shader::setMat4(const std::string& name, const glm::mat4 mat) {
-		use();
-		glUniformMatrix4fv(uniformLocations[name], 1, GL_FALSE, glm::value_ptr(mat));
+		set(resolveUniform<glm::mat4>(name, false), mat);
 	}
 
 	void Shader::setVec2(const std::string& name, const glm::vec2 vec) {
-		use();
-		glUniform2f(uniformLocations[name], vec.x, vec.y);
+		set(resolveUniform<glm::vec2>(name, false), vec);
 	}
 
 	void Shader::setVec3(const std::string& name, const glm::vec3 vec) {
-		use();
-		glUniform3f(uniformLocations[name], vec.x, vec.y, vec.z);
+		set(resolveUniform<glm::vec3>(name, false), vec);
 	}
 
 	void Shader::setVec4(const std::string& name, const glm::vec4 vec) {
-		use();
-		glUniform4f(uniformLocations[name], vec.x, vec.y, vec.z, vec.w);
+		set(resolveUniform<glm::vec4>(name, false), vec);
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,112 @@
+#include "engine/shaderManager.h"
+#include "engine/programCache.h"
+#include "engine/renderState.h"
+
+// KHR_parallel_shader_compile is not in the generated loader
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace Engine {
+	static bool hasExtension(const char* name) {
+		GLint count = 0;
+		glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++) {
+			const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+			if (extension && strcmp(extension, name) == 0) return true;
+		}
+		return false;
+	}
+
+	// The driver picks its compiler thread count, glMaxShaderCompilerThreadsKHR is left at the default
+	ShaderManager::ShaderManager(ProgramCache* cache) : cache(cache) {
+		parallelCompile = hasExtension("GL_KHR_parallel_shader_compile") || hasExtension("GL_ARB_parallel_shader_compile");
+	}
+
+	ShaderManager::~ShaderManager() {
+		for (auto& it : entries) {
+			Entry& entry = it.second;
+			if (entry.shader) {
+				glDeleteProgram(entry.shader->id());
+				RenderState::forgetProgram(entry.shader->id());
+			}
+			else if (entry.fromCache) {
+				glDeleteProgram(entry.pending.programId);
+				RenderState::forgetProgram(entry.pending.programId);
+			}
+			else Shader::deletePending(entry.pending);
+		}
+	}
+
+	void ShaderManager::submit(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath) {
+		if (entries.count(name) != 0) throw std::runtime_error("ERROR::SHADER_MANAGER::DUPLICATE_NAME " + name);
+		const std::string vertexCode = Shader::readSource(vertexPath);
+		const std::string fragmentCode = Shader::readSource(fragmentPath);
+
+		Entry entry;
+		const bool useCache = cache != nullptr && cache->isSupported();
+		if (useCache) {
+			entry.cacheKey = cache->makeKey({ vertexCode, fragmentCode });
+			entry.pending.programId = cache->load(entry.cacheKey);
+			entry.fromCache = entry.pending.programId != 0;
+		}
+		if (!entry.fromCache) entry.pending = Shader::beginProgram(vertexCode, fragmentCode, useCache);
+		entries.emplace(name, std::move(entry));
+	}
+
+	ShaderManager::Entry& ShaderManager::find(const std::string& name) {
+		auto it = entries.find(name);
+		if (it == entries.end()) throw std::runtime_error("ERROR::SHADER_MANAGER::UNKNOWN_NAME " + name);
+		return it->second;
+	}
+
+	bool ShaderManager::isReady(const std::string& name) {
+		Entry& entry = find(name);
+		if (entry.shader || entry.fromCache || !parallelCompile) return true;
+		GLint complete = GL_FALSE;
+		glGetProgramiv(entry.pending.programId, GL_COMPLETION_STATUS_KHR, &complete);
+		return complete == GL_TRUE;
+	}
+
+	Shader& ShaderManager::get(const std::string& name) {
+		Entry& entry = find(name);
+		if (entry.shader) return *entry.shader;
+		return finish(name, entry);
+	}
+
+	Shader& ShaderManager::finish(const std::string& name, Entry& entry) {
+		GLuint program;
+		if (entry.fromCache) {
+			program = entry.pending.programId;
+		}
+		else {
+			try {
+				program = Shader::finishProgram(entry.pending);
+			}
+			catch (...) {
+				// finishProgram already freed the objects, a retry has to submit again
+				entries.erase(name);
+				throw;
+			}
+			if (cache != nullptr && cache->isSupported()) cache->store(entry.cacheKey, program);
+		}
+		entry.shader.reset(new Shader(program));
+		return *entry.shader;
+	}
+
+	void ShaderManager::finishAll() {
+		std::vector<std::string> names;
+		for (auto& it : entries) {
+			if (!it.second.shader) names.push_back(it.first);
+		}
+		for (const std::string& name : names) get(name);
+	}
+
+	size_t ShaderManager::pendingCount() const {
+		size_t count = 0;
+		for (auto& it : entries) {
+			if (!it.second.shader) count++;
+		}
+		return count;
+	}
+}
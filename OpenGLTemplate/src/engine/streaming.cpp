@@ -0,0 +1,320 @@
+#include "engine/streaming.h"
+#include "engine/jobs.h"
+#include "engine/mesher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <queue>
+
+namespace Engine {
+	struct SectionMesh {
+		int sectionY;
+		Mesher::MeshData mesh;
+	};
+
+	// Shared between the streamer and the job, so a job whose column was unloaded can
+	// still finish (or notice it was cancelled) without touching freed memory
+	struct ChunkStreamer::Task {
+		enum Type { LOAD, MESH };
+
+		Type type;
+		int chunkX, chunkZ;
+		int lod;
+		Jobs::Counter counter;
+		std::atomic<bool> cancelled;
+
+		std::shared_ptr<Chunk> chunk;
+		bool fromDisk;
+		std::vector<SectionMesh> meshes;
+
+		Task(Type type, int chunkX, int chunkZ, int lod) :
+			type(type), chunkX(chunkX), chunkZ(chunkZ), lod(lod), cancelled(false), fromDisk(false) {}
+	};
+
+	struct ChunkStreamer::Column {
+		int chunkX, chunkZ;
+		std::shared_ptr<const Chunk> chunk;		// nullptr until loaded
+		std::shared_ptr<Task> loadTask;
+		std::shared_ptr<Task> meshTask;
+
+		// Meshes built but not uploaded yet, replace the uploaded ones when they are
+		std::vector<SectionMesh> pendingMeshes;
+		bool hasPendingMeshes;
+		std::vector<std::pair<int, ChunkRenderer::MeshId>> uploaded;
+		bool everUploaded;
+		int meshedLod;	// Level of the newest finished mesh, -1 for none
+
+		Column(int chunkX, int chunkZ) :
+			chunkX(chunkX), chunkZ(chunkZ), hasPendingMeshes(false), everUploaded(false), meshedLod(-1) {}
+	};
+
+	static uint64_t columnKey(int chunkX, int chunkZ) {
+		return ((uint64_t)(uint32_t)chunkX << 32) | (uint32_t)chunkZ;
+	}
+
+	ChunkStreamer::ChunkStreamer(const TerrainGenerator& generator, ChunkRenderer& renderer, RegionStorage* storage, const StreamingSettings& settings) :
+		generator(generator), renderer(renderer), storage(storage), settings(settings), cameraChunk(0), totals() {
+	}
+
+	ChunkStreamer::~ChunkStreamer() {
+		for (const std::shared_ptr<Task>& task : tasksInFlight) task->cancelled = true;
+		for (const std::shared_ptr<Task>& task : tasksInFlight) Jobs::wait(task->counter);
+		for (auto& entry : columns) {
+			for (auto& mesh : entry.second->uploaded) renderer.removeMesh(mesh.second);
+		}
+	}
+
+	ChunkStreamer::Column* ChunkStreamer::findColumn(int chunkX, int chunkZ) const {
+		auto it = columns.find(columnKey(chunkX, chunkZ));
+		return it == columns.end() ? nullptr : it->second.get();
+	}
+
+	bool ChunkStreamer::neighboursLoaded(int chunkX, int chunkZ) const {
+		for (int dz = -1; dz <= 1; dz++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				Column* column = findColumn(chunkX + dx, chunkZ + dz);
+				if (column == nullptr || !column->chunk) return false;
+			}
+		}
+		return true;
+	}
+
+	void ChunkStreamer::update(const glm::mat4& viewMatrix) {
+		glm::mat4 cameraMatrix = glm::inverse(viewMatrix);
+		glm::vec3 cameraPosition = glm::vec3(cameraMatrix[3]);
+		glm::vec3 forward = -glm::vec3(cameraMatrix[2]);
+		cameraChunk = glm::ivec2(glm::floor(glm::vec2(cameraPosition.x, cameraPosition.z) / (float)ChunkSection::SIZE));
+
+		finishTasks();
+		unloadDistantColumns(cameraPosition);
+		uploadMeshes();
+		startJobs(cameraPosition, forward);
+	}
+
+	void ChunkStreamer::finishTasks() {
+		size_t kept = 0;
+		for (size_t i = 0; i < tasksInFlight.size(); i++) {
+			std::shared_ptr<Task>& task = tasksInFlight[i];
+			if (!task->counter.isDone()) {
+				tasksInFlight[kept++] = task;
+				continue;
+			}
+			if (task->cancelled) continue;
+
+			Column* column = findColumn(task->chunkX, task->chunkZ);
+			if (task->type == Task::LOAD) {
+				column->chunk = task->chunk;
+				column->loadTask.reset();
+				if (task->fromDisk) totals.loadedFromDisk++;
+				else totals.generated++;
+			}
+			else {
+				column->pendingMeshes = std::move(task->meshes);
+				column->hasPendingMeshes = true;
+				column->meshedLod = task->lod;
+				column->meshTask.reset();
+				totals.meshed++;
+			}
+		}
+		tasksInFlight.resize(kept);
+	}
+
+	void ChunkStreamer::unloadDistantColumns(const glm::vec3& cameraPosition) {
+		const float unloadDistance = (float)settings.renderDistance + 2.0f;
+		for (auto it = columns.begin(); it != columns.end();) {
+			Column& column = *it->second;
+			if (Lod::chunkDistance(cameraPosition, column.chunkX, column.chunkZ) <= unloadDistance) {
+				++it;
+				continue;
+			}
+
+			// Jobs not started yet return straight away, running mesh jobs stop at the next section
+			if (column.loadTask && !column.loadTask->cancelled.exchange(true)) totals.cancelled++;
+			if (column.meshTask && !column.meshTask->cancelled.exchange(true)) totals.cancelled++;
+			for (auto& mesh : column.uploaded) renderer.removeMesh(mesh.second);
+			it = columns.erase(it);
+			totals.unloaded++;
+		}
+	}
+
+	void ChunkStreamer::uploadMeshes() {
+		std::vector<std::pair<int, Column*>> ready;
+		for (auto& entry : columns) {
+			Column* column = entry.second.get();
+			if (!column->hasPendingMeshes) continue;
+			glm::ivec2 offset = glm::ivec2(column->chunkX, column->chunkZ) - cameraChunk;
+			ready.push_back(std::make_pair(offset.x * offset.x + offset.y * offset.y, column));
+		}
+
+		// Nearest first
+		size_t count = std::min(ready.size(), (size_t)std::max(0, settings.maxUploadsPerFrame));
+		std::partial_sort(ready.begin(), ready.begin() + count, ready.end(),
+			[](const std::pair<int, Column*>& a, const std::pair<int, Column*>& b) { return a.first < b.first; });
+		for (size_t i = 0; i < count; i++) {
+			Column& column = *ready[i].second;
+			for (auto& mesh : column.uploaded) renderer.removeMesh(mesh.second);
+			column.uploaded.clear();
+			for (const SectionMesh& section : column.pendingMeshes) {
+				const Mesher::MeshData& mesh = section.mesh;
+				ChunkRenderer::MeshId id = renderer.uploadMesh(mesh.vertices.data(), mesh.vertices.size(), mesh.indices.data(), mesh.indices.size());
+				column.uploaded.push_back(std::make_pair(section.sectionY, id));
+			}
+			column.pendingMeshes.clear();
+			column.pendingMeshes.shrink_to_fit();
+			column.hasPendingMeshes = false;
+			column.everUploaded = true;
+			totals.uploaded++;
+		}
+	}
+
+	void ChunkStreamer::startJobs(const glm::vec3& cameraPosition, const glm::vec3& forward) {
+		int budget = std::min(settings.maxJobsPerFrame, settings.maxJobsInFlight - (int)tasksInFlight.size());
+		if (budget <= 0) return;
+
+		struct Candidate {
+			float priority;
+			int chunkX, chunkZ;
+			int lod;	// -1 to load, else the level to mesh at
+			bool operator<(const Candidate& other) const { return priority > other.priority; }
+		};
+		std::priority_queue<Candidate> candidates;
+
+		glm::vec2 viewDirection = glm::vec2(forward.x, forward.z);
+		if (glm::length(viewDirection) > 1e-4f) viewDirection = glm::normalize(viewDirection);
+		else viewDirection = glm::vec2(0.0f);
+		const glm::vec2 camera = glm::vec2(cameraPosition.x, cameraPosition.z) / (float)ChunkSection::SIZE;
+		const int loadDistance = settings.renderDistance + 1;
+
+		for (int dz = -loadDistance; dz <= loadDistance; dz++) {
+			for (int dx = -loadDistance; dx <= loadDistance; dx++) {
+				const int chunkX = cameraChunk.x + dx;
+				const int chunkZ = cameraChunk.y + dz;
+				float distance = Lod::chunkDistance(cameraPosition, chunkX, chunkZ);
+				if (distance > (float)loadDistance) continue;
+
+				glm::vec2 toChunk = glm::vec2(chunkX + 0.5f, chunkZ + 0.5f) - camera;
+				float facing = glm::length(toChunk) > 1e-4f ? glm::dot(glm::normalize(toChunk), viewDirection) : 1.0f;
+				float priority = distance - settings.viewBias * facing;
+
+				Column* column = findColumn(chunkX, chunkZ);
+				if (column == nullptr) {
+					candidates.push({ priority, chunkX, chunkZ, -1 });
+					continue;
+				}
+				if (!column->chunk || column->meshTask || distance > (float)settings.renderDistance) continue;
+
+				int lod = Lod::selectLod(settings.lod, distance, column->meshedLod);
+				if (lod != column->meshedLod && neighboursLoaded(chunkX, chunkZ)) {
+					candidates.push({ priority, chunkX, chunkZ, lod });
+				}
+			}
+		}
+
+		for (; budget > 0 && !candidates.empty(); budget--) {
+			const Candidate& candidate = candidates.top();
+			if (candidate.lod < 0) startLoad(candidate.chunkX, candidate.chunkZ);
+			else startMesh(*findColumn(candidate.chunkX, candidate.chunkZ), candidate.lod);
+			candidates.pop();
+		}
+	}
+
+	void ChunkStreamer::startLoad(int chunkX, int chunkZ) {
+		std::unique_ptr<Column>& column = columns[columnKey(chunkX, chunkZ)];
+		column.reset(new Column(chunkX, chunkZ));
+		std::shared_ptr<Task> task = std::make_shared<Task>(Task::LOAD, chunkX, chunkZ, 0);
+		column->loadTask = task;
+		tasksInFlight.push_back(task);
+
+		const TerrainGenerator* generator = &this->generator;
+		RegionStorage* storage = this->storage;
+		const int sectionCount = settings.sectionCount;
+		Jobs::submit([task, generator, storage, sectionCount]() {
+			if (task->cancelled) return;
+			std::shared_ptr<Chunk> chunk = std::make_shared<Chunk>(sectionCount);
+			if (storage != nullptr) {
+				try {
+					task->fromDisk = storage->load(task->chunkX, task->chunkZ, *chunk);
+				}
+				catch (std::exception& e) {
+					std::cout << e.what() << std::endl;
+				}
+			}
+			if (!task->fromDisk) {
+				generator->generate(*chunk, task->chunkX, task->chunkZ);
+				if (storage != nullptr) {
+					try {
+						storage->save(task->chunkX, task->chunkZ, *chunk);
+					}
+					catch (std::exception& e) {
+						std::cout << e.what() << std::endl;
+					}
+				}
+			}
+			task->chunk = chunk;
+		}, &task->counter);
+	}
+
+	void ChunkStreamer::startMesh(Column& column, int lod) {
+		std::shared_ptr<Task> task = std::make_shared<Task>(Task::MESH, column.chunkX, column.chunkZ, lod);
+		column.meshTask = task;
+		tasksInFlight.push_back(task);
+
+		// Holding the neighbours keeps them alive even if they are unloaded mid-job
+		std::vector<std::shared_ptr<const Chunk>> neighbourhood(9);
+		for (int dz = -1; dz <= 1; dz++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				neighbourhood[(dz + 1) * 3 + (dx + 1)] = findColumn(column.chunkX + dx, column.chunkZ + dz)->chunk;
+			}
+		}
+
+		Jobs::submit([task, neighbourhood]() {
+			const Chunk* chunks[9];
+			for (int i = 0; i < 9; i++) chunks[i] = neighbourhood[i].get();
+			const Chunk& chunk = *chunks[4];
+
+			std::vector<BlockId> padded(task->lod == 0 ? Mesher::PADDED_VOLUME : Mesher::LOD_PADDED_VOLUME);
+			Mesher::MeshData mesh;
+			for (int sectionY = 0; sectionY < chunk.sectionCount(); sectionY++) {
+				if (task->cancelled) return;
+				const ChunkSection& section = chunk.getSection(sectionY);
+				if (section.isUniform() && !Blocks::isOpaque(section.get(0, 0, 0))) continue;
+
+				if (task->lod == 0) {
+					buildPaddedSection(chunks, sectionY, padded.data());
+					Mesher::meshGreedy(padded.data(), mesh);
+				}
+				else {
+					buildLodPaddedSection(chunks, sectionY, task->lod, padded.data());
+					Mesher::meshGreedyLod(padded.data(), task->lod, mesh);
+				}
+				if (!mesh.indices.empty()) task->meshes.push_back({ sectionY, mesh });
+			}
+		}, &task->counter);
+	}
+
+	size_t ChunkStreamer::submitDraws(const Culling::Frustum& frustum) {
+		const float size = (float)ChunkSection::SIZE;
+		size_t count = 0;
+		for (auto& entry : columns) {
+			const Column& column = *entry.second;
+			for (const auto& mesh : column.uploaded) {
+				glm::vec3 min = glm::vec3((float)column.chunkX, (float)mesh.first, (float)column.chunkZ) * size;
+				if (!Culling::isAabbVisible(frustum, min, min + glm::vec3(size))) continue;
+				renderer.addDraw(mesh.second, min);
+				count++;
+			}
+		}
+		return count;
+	}
+
+	size_t ChunkStreamer::drawableColumns() const {
+		size_t count = 0;
+		for (const auto& entry : columns) count += entry.second->everUploaded ? 1 : 0;
+		return count;
+	}
+
+	bool ChunkStreamer::isColumnDrawable(int chunkX, int chunkZ) const {
+		Column* column = findColumn(chunkX, chunkZ);
+		return column != nullptr && column->everUploaded;
+	}
+}
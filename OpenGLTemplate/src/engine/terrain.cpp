@@ -0,0 +1,64 @@
+#include "engine/terrain.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+	TerrainGenerator::TerrainGenerator(int32_t seed, Noise::Isa isa)
+		: isa(isa), baseHeight(64), heightRange(40), seaLevel(62) {
+		heightNoise = { seed, 5, 1.0f / 256.0f, 2.0f, 0.5f };
+		caveNoise = { seed ^ 0x5bd1e995, 2, 1.0f / 48.0f, 2.0f, 0.5f };
+	}
+
+	void TerrainGenerator::generate(Chunk& chunk, int chunkX, int chunkZ) const {
+		const int size = ChunkSection::SIZE;
+		const float originX = (float)(chunkX * size);
+		const float originZ = (float)(chunkZ * size);
+
+		// Whole column heightmap in one call
+		float heightSamples[size * size];
+		Noise::fbm2D(isa, heightNoise, originX, originZ, 1.0f, size, size, heightSamples);
+		int heights[size * size];
+		int maxHeight = 0;
+		for (int i = 0; i < size * size; i++) {
+			heights[i] = std::min(chunk.height() - 2, std::max(1, baseHeight + (int)std::floor(heightSamples[i] * heightRange)));
+			maxHeight = std::max(maxHeight, heights[i]);
+		}
+
+		// Caves only need sampling up to the highest surface block
+		const int caveHeight = maxHeight + 1;
+		std::vector<float> caveSamples((size_t)size * size * caveHeight);
+		Noise::fbm3D(isa, caveNoise, originX, 0.0f, originZ, 1.0f, size, caveHeight, size, caveSamples.data());
+
+		BlockId blocks[ChunkSection::VOLUME];
+		for (int sectionY = 0; sectionY < chunk.sectionCount(); sectionY++) {
+			ChunkSection& section = chunk.getSection(sectionY);
+			if (sectionY * size > maxHeight) {
+				section.fill(Blocks::AIR);
+				continue;
+			}
+			for (int y = 0; y < size; y++) {
+				const int worldY = sectionY * size + y;
+				for (int z = 0; z < size; z++) {
+					for (int x = 0; x < size; x++) {
+						const int height = heights[z * size + x];
+						BlockId block = Blocks::AIR;
+						if (worldY == 0) {
+							block = Blocks::BEDROCK;
+						}
+						else if (worldY <= height) {
+							// Thin worm-like tunnels where the cave noise crosses zero
+							float cave = caveSamples[((size_t)worldY * size + z) * size + x];
+							if (worldY > 4 && std::fabs(cave) < 0.06f) block = Blocks::AIR;
+							else if (worldY == height) block = height <= seaLevel + 1 ? Blocks::SAND : Blocks::GRASS;
+							else if (worldY > height - 4) block = height <= seaLevel + 1 ? Blocks::SAND : Blocks::DIRT;
+							else block = Blocks::STONE;
+						}
+						blocks[(y * size + z) * size + x] = block;
+					}
+				}
+			}
+			section.assign(blocks);
+		}
+	}
+}
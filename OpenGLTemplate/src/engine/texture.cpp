@@ -0,0 +1,72 @@
+#include "engine/texture.h"
+#include "engine/image.h"
+#include "engine/jobs.h"
+#include "engine/renderState.h"
+#include "engine/profiler.h"
+
+#include <algorithm>
+
+namespace Engine {
+	TextureArray::TextureArray(const std::vector<std::string>& paths) : textureID(0), width(0), height(0), layers((int)paths.size()), levels(0) {
+		PROFILE_FUNCTION();
+		if (paths.empty()) throw std::runtime_error("ERROR::TEXTURE::NO_LAYERS");
+		GLint maxLayers = 0;
+		glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+		if (layers > maxLayers) throw std::runtime_error("ERROR::TEXTURE::TOO_MANY_LAYERS");
+
+		// Decode on the workers, a failed image keeps its message for the GL thread to throw
+		std::vector<Image> images(paths.size());
+		std::vector<std::string> errors(paths.size());
+		Jobs::Counter decoded;
+		Jobs::parallelFor(layers, 1, [&](int begin, int end) {
+			PROFILE_SCOPE("Decode PNG");
+			for (int i = begin; i < end; i++) {
+				try {
+					images[i] = Png::load(paths[i]);
+				}
+				catch (std::exception& e) {
+					errors[i] = e.what();
+				}
+			}
+		}, &decoded);
+		Jobs::wait(decoded);
+		for (const std::string& error : errors) {
+			if (!error.empty()) throw std::runtime_error(error);
+		}
+
+		width = images[0].width;
+		height = images[0].height;
+		for (size_t i = 1; i < images.size(); i++) {
+			if (images[i].width != width || images[i].height != height) throw std::runtime_error("ERROR::TEXTURE::LAYER_SIZE_MISMATCH " + paths[i]);
+		}
+		GLint maxSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+		if (width > maxSize || height > maxSize) throw std::runtime_error("ERROR::TEXTURE::TOO_LARGE");
+
+		// Full chain down to 1x1
+		for (int size = std::max(width, height); size > 0; size >>= 1) levels++;
+
+		glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &textureID);
+		glTextureStorage3D(textureID, levels, GL_RGBA8, width, height, layers);
+		for (int layer = 0; layer < layers; layer++) {
+			glTextureSubImage3D(textureID, 0, 0, 0, layer, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, images[layer].pixels.data());
+		}
+		glGenerateTextureMipmap(textureID);
+
+		glTextureParameteri(textureID, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_LINEAR);
+		glTextureParameteri(textureID, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTextureParameteri(textureID, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTextureParameteri(textureID, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	}
+
+	TextureArray::~TextureArray() {
+		if (textureID != 0) {
+			glDeleteTextures(1, &textureID);
+			RenderState::forgetTexture(textureID);
+		}
+	}
+
+	void TextureArray::bind(GLuint unit) const {
+		RenderState::bindTextureUnit(unit, textureID);
+	}
+}
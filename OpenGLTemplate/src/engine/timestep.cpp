@@ -0,0 +1,37 @@
+#include "engine/timestep.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine {
+	FixedTimestep::FixedTimestep(const TimestepSettings& settings)
+		: settings(settings), tickDuration(1.0 / settings.ticksPerSecond), accumulator(0.0), frameStats() {
+		if (settings.ticksPerSecond <= 0.0 || settings.maxTicksPerFrame < 1) throw std::runtime_error("ERROR::TIMESTEP::INVALID_SETTINGS");
+	}
+
+	int FixedTimestep::advance(double frameSeconds) {
+		frameStats.frames++;
+		if (frameSeconds > settings.maxFrameSeconds) {
+			frameStats.droppedTicks += (uint64_t)((frameSeconds - settings.maxFrameSeconds) / tickDuration);
+			frameSeconds = settings.maxFrameSeconds;
+		}
+		accumulator += std::max(frameSeconds, 0.0);
+
+		int ticks = (int)std::floor(accumulator / tickDuration);
+		if (ticks > settings.maxTicksPerFrame) {
+			frameStats.droppedTicks += (uint64_t)(ticks - settings.maxTicksPerFrame);
+			ticks = settings.maxTicksPerFrame;
+			// Keep only the partial tick so alpha stays meaningful
+			accumulator = std::fmod(accumulator, tickDuration);
+		}
+		else {
+			accumulator -= ticks * tickDuration;
+		}
+		// Rounding can leave the accumulator a hair outside [0, tickDuration)
+		accumulator = std::min(std::max(accumulator, 0.0), std::nextafter(tickDuration, 0.0));
+
+		frameStats.ticks += ticks;
+		frameStats.maxTicksInFrame = std::max(frameStats.maxTicksInFrame, ticks);
+		return ticks;
+	}
+}
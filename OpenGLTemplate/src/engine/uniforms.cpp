@@ -0,0 +1,35 @@
+#include "engine/uniforms.h"
+#include "engine/renderState.h"
+
+namespace Engine {
+	FrameUniforms::FrameUniforms() : data() {
+		data.view = glm::mat4(1.0f);
+		data.projection = glm::mat4(1.0f);
+		data.viewProjection = glm::mat4(1.0f);
+		glCreateBuffers(1, &bufferId);
+		glNamedBufferStorage(bufferId, sizeof(FrameData), &data, GL_DYNAMIC_STORAGE_BIT);
+	}
+
+	FrameUniforms::~FrameUniforms() {
+		glDeleteBuffers(1, &bufferId);
+		RenderState::forgetBuffer(bufferId);
+	}
+
+	void FrameUniforms::setCamera(const glm::mat4& view, const glm::mat4& projection) {
+		data.view = view;
+		data.projection = projection;
+		data.viewProjection = projection * view;
+		data.cameraPosition = glm::vec4(glm::vec3(glm::inverse(view)[3]), 1.0f);
+	}
+
+	void FrameUniforms::setFog(const glm::vec3& color, float start, float end) {
+		data.fogColor = glm::vec4(color, 1.0f);
+		data.fogStart = start;
+		data.fogEnd = end;
+	}
+
+	void FrameUniforms::update() {
+		glNamedBufferSubData(bufferId, 0, sizeof(FrameData), &data);
+		RenderState::bindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, bufferId);
+	}
+}
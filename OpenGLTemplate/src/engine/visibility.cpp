@@ -0,0 +1,90 @@
+#include "engine/visibility.h"
+
+namespace Engine {
+	static const glm::ivec3 faceStep[FACE_COUNT] = {
+		glm::ivec3(1, 0, 0), glm::ivec3(-1, 0, 0),
+		glm::ivec3(0, 1, 0), glm::ivec3(0, -1, 0),
+		glm::ivec3(0, 0, 1), glm::ivec3(0, 0, -1),
+	};
+	// Faces come in +/- pairs
+	static int oppositeFace(int face) { return face ^ 1; }
+	static const uint8_t noEntryFace = FACE_COUNT;
+
+	VisibilityGraph::VisibilityGraph(const glm::ivec3& originSection, const glm::ivec3& sizeInSections) :
+		origin(originSection),
+		size(sizeInSections),
+		connectivity((size_t)sizeInSections.x * sizeInSections.y * sizeInSections.z, Mesher::ALL_FACES_CONNECTED),
+		visitedStamp(connectivity.size(), 0),
+		entryFace(connectivity.size(), noEntryFace),
+		directions(connectivity.size(), 0),
+		stamp(0),
+		lastStats() {
+		queue.reserve(connectivity.size());
+	}
+
+	bool VisibilityGraph::contains(const glm::ivec3& section) const {
+		glm::ivec3 p = section - origin;
+		return p.x >= 0 && p.y >= 0 && p.z >= 0 && p.x < size.x && p.y < size.y && p.z < size.z;
+	}
+
+	void VisibilityGraph::setConnectivity(const glm::ivec3& section, Mesher::FaceConnectivity faces) {
+		if (contains(section)) connectivity[cellIndex(section)] = faces;
+	}
+
+	glm::ivec3 VisibilityGraph::sectionAt(int index) const {
+		return origin + glm::ivec3(index % size.x, index / (size.x * size.z), (index / size.x) % size.z);
+	}
+
+	void VisibilityGraph::findVisible(const glm::vec3& cameraPosition, const Culling::Frustum& frustum, std::vector<uint32_t>& visible) {
+		visible.clear();
+		queue.clear();
+		lastStats = VisibilityStats();
+		if (connectivity.empty()) return;
+
+		if (++stamp == 0) {
+			// Wrapped around, old stamps could match again
+			std::fill(visitedStamp.begin(), visitedStamp.end(), 0);
+			stamp = 1;
+		}
+
+		const float sectionSize = (float)Mesher::SECTION_SIZE;
+		glm::ivec3 start = glm::ivec3(glm::floor(cameraPosition / sectionSize));
+		start = glm::clamp(start, origin, origin + size - glm::ivec3(1));
+
+		// The camera section is open in every direction, the camera may be inside a wall of it
+		int startIndex = cellIndex(start);
+		visitedStamp[startIndex] = stamp;
+		entryFace[startIndex] = noEntryFace;
+		directions[startIndex] = 0;
+		queue.push_back((uint32_t)startIndex);
+
+		for (size_t head = 0; head < queue.size(); head++) {
+			int index = (int)queue[head];
+			visible.push_back((uint32_t)index);
+
+			glm::ivec3 section = sectionAt(index);
+			Mesher::FaceConnectivity faces = connectivity[index];
+			int entry = entryFace[index];
+			for (int face = 0; face < FACE_COUNT; face++) {
+				// Never walk back towards the camera, every step moves the view ray further away
+				if (directions[index] & (1u << oppositeFace(face))) continue;
+				if (entry != noEntryFace && !Mesher::facesConnected(faces, entry, face)) continue;
+
+				glm::ivec3 neighbour = section + faceStep[face];
+				if (!contains(neighbour)) continue;
+				int neighbourIndex = cellIndex(neighbour);
+				if (visitedStamp[neighbourIndex] == stamp) continue;
+				visitedStamp[neighbourIndex] = stamp;
+
+				lastStats.sectionsTested++;
+				glm::vec3 min = glm::vec3(neighbour) * sectionSize;
+				if (!Culling::isAabbVisible(frustum, min, min + glm::vec3(sectionSize))) continue;
+
+				entryFace[neighbourIndex] = (uint8_t)oppositeFace(face);
+				directions[neighbourIndex] = directions[index] | (uint8_t)(1u << face);
+				queue.push_back((uint32_t)neighbourIndex);
+			}
+		}
+		lastStats.sectionsVisible = visible.size();
+	}
+}
@@ -6,8 +6,10 @@ namespace Engine {
 		GLFWwindow* nativeWindow = nullptr;
 		int windowWidth = 0;
 		int windowHeight = 0;
+		bool focused = true;
+		bool iconified = false;
 
-		bool createWindow(int width, int height, const char* title, bool fullScreenMode) {
+		bool createWindow(int width, int height, const char* title, bool fullScreenMode, bool hidden) {
 			// Init GLFW
 			if (!glfwInit()) {
 				printf("Failed to initialize GLFW.");
@@ -19,6 +21,8 @@ namespace Engine {
 			glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 			// Load OpenGL Core Profile (No deprecated functions)
 			glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+			// Set hidden mode for offscreen rendering
+			glfwWindowHint(GLFW_VISIBLE, hidden ? GLFW_FALSE : GLFW_TRUE);
 
 			// Get primary monitor & set fullscreen mode if required
 			GLFWmonitor* primaryMonitor = nullptr;
@@ -29,8 +33,12 @@ namespace Engine {
 				height = mode->height;
 			}
 
-			// Create window
+			// Create window, fall back to OpenGL 4.5 (e.g. Mesa) as DSA is the minimum we need
 			nativeWindow = glfwCreateWindow(width, height, title, primaryMonitor, nullptr);
+			if (nativeWindow == nullptr) {
+				glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
+				nativeWindow = glfwCreateWindow(width, height, title, primaryMonitor, nullptr);
+			}
 			windowWidth = width;
 			windowHeight = height;
 			if (nativeWindow == nullptr) {
@@ -39,6 +47,9 @@ namespace Engine {
 				return false;
 			}
 			glfwMakeContextCurrent(nativeWindow);
+			// A hidden window never gets focus, it renders offscreen so count it as watched
+			focused = hidden || glfwGetWindowAttrib(nativeWindow, GLFW_FOCUSED) == GLFW_TRUE;
+			iconified = false;
 			addWindowCallbacks();
 
 			// Init GLAD (Load OpenGL functions)
@@ -58,6 +69,9 @@ namespace Engine {
 				glfwSetKeyCallback(nativeWindow, Input::keyCallback);					// Window key callback
 				glfwSetCursorPosCallback(nativeWindow, Input::mousePosCallback);			// Window mouse position callback
 				glfwSetMouseButtonCallback(nativeWindow, Input::mouseButtonCallback);	// Window mouse button callback
+				glfwSetScrollCallback(nativeWindow, Input::mouseScrollCallback);			// Window mouse scroll callback
+				glfwSetWindowFocusCallback(nativeWindow, windowFocusCallback);				// Window focus callback
+				glfwSetWindowIconifyCallback(nativeWindow, windowIconifyCallback);			// Window minimize callback
 			}
 		}
 
@@ -68,6 +82,14 @@ namespace Engine {
 			printf("Window size is: %d x %d\n", width, height);
 		}
 
+		void windowFocusCallback(GLFWwindow* window, int windowFocused) {
+			if (glfwGetWindowAttrib(window, GLFW_VISIBLE) == GLFW_TRUE) focused = windowFocused == GLFW_TRUE;
+		}
+
+		void windowIconifyCallback(GLFWwindow* window, int windowIconified) {
+			iconified = windowIconified == GLFW_TRUE;
+		}
+
 		void close() {
 			if (nativeWindow != nullptr)
 				glfwSetWindowShouldClose(nativeWindow, GLFW_TRUE);
@@ -2,13 +2,40 @@
 #include "engine/window.h"
 #include "engine/input.h"
 #include "engine/shader.h"
+#include "engine/shaderManager.h"
 #include "engine/buffers.h"
+#include "engine/renderState.h"
+#include "engine/uniforms.h"
+#include "engine/programCache.h"
+#include "engine/profiler.h"
+#include "engine/timestep.h"
+#include "engine/framePacer.h"
+#include "engine/idleThrottle.h"
 
 using namespace Engine;
 
 void terminateGLFW();
+glm::vec3 movementDirection(bool (*keyDown)(int));
 
-int main() {
+// Options
+//   --profile               write the last frames to frameTrace.json (chrome://tracing) on exit
+//   --vsync (default)       --uncapped       --cap <fps>
+//   --frames-in-flight <n>  0 - 4, 0 leaves queuing to the driver, default 1
+//   --no-late-latch         render the interpolated tick instead of extrapolating with fresh input
+int main(int argc, char** argv) {
+	bool profile = false;
+	PacingSettings pacing = defaultPacing;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--profile") == 0) profile = true;
+		else if (strcmp(argv[i], "--vsync") == 0) pacing.mode = PresentMode::VSYNC;
+		else if (strcmp(argv[i], "--uncapped") == 0) pacing.mode = PresentMode::UNCAPPED;
+		else if (strcmp(argv[i], "--cap") == 0 && i + 1 < argc) {
+			pacing.mode = PresentMode::CAPPED;
+			pacing.capFps = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc) pacing.maxFramesInFlight = atoi(argv[++i]);
+		else if (strcmp(argv[i], "--no-late-latch") == 0) pacing.lateLatch = false;
+	}
 	const int windowWidth = 1920;
 	const int windowHeight = 1080;
 	const bool fullScreenMode = false;
@@ -17,17 +44,39 @@ int main() {
 	const bool success = Window::createWindow(windowWidth, windowHeight, "OpenGL Template", fullScreenMode);
 	if (!success) return -1;
 
-	// Initialize shader
-	// Remember to delete shaders created this way at the end
-	Shader* shader = NULL;
+	// Start compiling shaders, they are collected once the buffers are set up
+	// Linked programs are cached on disk, later runs skip compilation
+	ProgramCache* programCache = NULL;
+	ShaderManager* shaders = NULL;
+	try {
+		programCache = new ProgramCache("shaderCache");
+		shaders = new ShaderManager(programCache);
+		shaders->submit("basic", "assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		delete shaders;
+		delete programCache;
+		terminateGLFW();
+		return -1;
+	}
+
+	// View / projection / time / fog for every shader, updated once per frame
+	FrameUniforms* frameUniforms = new FrameUniforms();
+
+	FramePacer* pacer = NULL;
 	try {
-		shader = new Shader("assets/shaders/vertexShader.glsl", "assets/shaders/fragmentShader.glsl");
+		pacer = new FramePacer(pacing);
 	}
 	catch (std::exception& e) {
 		std::cout << e.what() << std::endl;
+		delete frameUniforms;
+		delete shaders;
+		delete programCache;
 		terminateGLFW();
 		return -1;
 	}
+	glfwSwapInterval(pacer->swapInterval());
 
 	// Create vertices for a square
 	// Update Vertex in shader.h to add more attributes
@@ -61,6 +110,24 @@ int main() {
 	Buffers::addVertexAttrib(vaoID, 0, 3, offsetof(Vertex, position), bindingIndex);		// Position
 	Buffers::addVertexAttrib(vaoID, 1, 4, offsetof(Vertex, color), bindingIndex);		// Color
 
+	// Owned by the manager
+	Shader* shader = NULL;
+	try {
+		shader = &shaders->get("basic");
+	}
+	catch (std::exception& e) {
+		std::cout << e.what() << std::endl;
+		delete pacer;
+		delete frameUniforms;
+		delete shaders;
+		delete programCache;
+		terminateGLFW();
+		return -1;
+	}
+
+	// Per-object uniforms are resolved once
+	UniformHandle<glm::mat4> transformUniform = shader->getUniform<glm::mat4>("uTransform");
+
 	// Transform matrix
 	glm::vec3 scale = glm::vec3(5.0f);
 	float rotation = 0.0f;
@@ -96,52 +163,141 @@ int main() {
 	// Set clear color
 	glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 
+	Profiler::setEnabled(profile);
+
+	// The simulation runs at a fixed tick rate, rendering every frame in between
+	FixedTimestep timestep;
+	glm::mat4 previousTransformMatrix = transformMatrix;
+	double lastFrameTime = glfwGetTime();
+
+	// Nobody watching: unfocused the loop renders at 10 fps, minimized it stops rendering and only
+	// wakes up for simulation ticks, blocking in glfwWaitEventsTimeout meanwhile
+	WindowEventSource windowEvents;
+	windowEvents.focused = []() { return Window::focused; };
+	windowEvents.iconified = []() { return Window::iconified; };
+	windowEvents.shouldClose = []() { return glfwWindowShouldClose(Window::nativeWindow) == GLFW_TRUE; };
+	windowEvents.waitEvents = [](double seconds) { glfwWaitEventsTimeout(seconds); };
+	windowEvents.now = []() { return glfwGetTime(); };
+	IdleThrottle idleThrottle(windowEvents);
+	const double startTime = glfwGetTime();
+
 	// Main loop
 	while (!glfwWindowShouldClose(Window::nativeWindow)) {
-		// Clear the screen
-		glClear(GL_COLOR_BUFFER_BIT);
-
-		// Handle input
-		Input::handleKeyInput(transformMatrix);
-
-		// Render
-		Buffers::useVAO(vaoID);
-		shader->use();
-		shader->setMat4("uTransform", transformMatrix);
-		shader->setMat4("uView", viewMatrix);
-		shader->setMat4("uProjection", projectionMatrix);
-		//glDrawArrays(GL_TRIANGLES, 0, vertexCount);
-		glDrawElements(GL_TRIANGLES, indicesLen, GL_UNSIGNED_INT, 0);
-
-		// Swap buffers & Handle window events
-		glfwSwapBuffers(Window::nativeWindow);
-		glfwPollEvents();
+		const bool rendering = idleThrottle.wait(timestep);
+
+		RenderState::resetCounters();
+		Profiler::beginFrame();
+
+		// Wait for the GPU / frame cap first, so input is sampled as late as possible
+		if (rendering) pacer->beginFrame();
+		{
+			PROFILE_SCOPE("Input");
+			glfwPollEvents();
+			pacer->markInputLatched();
+		}
+
+		// Simulate, handle input once per tick
+		{
+			PROFILE_SCOPE("Simulation");
+			double now = glfwGetTime();
+			int ticks = timestep.advance(now - lastFrameTime);
+			lastFrameTime = now;
+			// Simulated time ends alpha ticks before now, each tick takes the input up to its own end
+			double tickEnd = now - (ticks + timestep.alpha()) * timestep.tickSeconds();
+			for (int i = 0; i < ticks; i++) {
+				tickEnd += timestep.tickSeconds();
+				Input::processEvents(tickEnd);
+				previousTransformMatrix = transformMatrix;
+				Input::handleKeyInput(transformMatrix, (float)timestep.tickSeconds());
+			}
+		}
+		if (!rendering) {
+			Profiler::endFrame();
+			continue;
+		}
+
+		{
+			PROFILE_SCOPE("Render");
+			PROFILE_GPU_SCOPE("Render");
+
+			// Clear the screen
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			glm::mat4 renderTransformMatrix;
+			if (pacing.lateLatch) {
+				// Poll again right before the upload and extrapolate the last tick by the keys held now,
+				// this shows the simulation alpha ticks ahead instead of one tick behind
+				glfwPollEvents();
+				pacer->markInputLatched();
+				float extrapolateSeconds = timestep.alpha() * (float)timestep.tickSeconds();
+				renderTransformMatrix = glm::translate(transformMatrix, movementDirection(Input::isKeyHeldNow) * 6.0f * extrapolateSeconds);
+			}
+			else {
+				// Blend the last two ticks, the transform only translates so a linear mix is exact
+				renderTransformMatrix = previousTransformMatrix + (transformMatrix - previousTransformMatrix) * timestep.alpha();
+			}
+
+			// Frame-global uniforms
+			frameUniforms->setCamera(viewMatrix, projectionMatrix);
+			frameUniforms->setTime((float)glfwGetTime());
+			frameUniforms->update();
+
+			// Render
+			Buffers::useVAO(vaoID);
+			shader->use();
+			Shader::set(transformUniform, renderTransformMatrix);
+			//glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+			glDrawElements(GL_TRIANGLES, indicesLen, GL_UNSIGNED_INT, 0);
+		}
+
+		// Swap buffers, window events are polled at the start of the next frame
+		{
+			PROFILE_SCOPE("Present");
+			glfwSwapBuffers(Window::nativeWindow);
+		}
+		pacer->endFrame();
+		Profiler::endFrame();
+	}
+	pacer->printStats();
+	printf("Idle %.1f s of %.1f s\n", idleThrottle.stats().idleSeconds, glfwGetTime() - startTime);
+
+	if (profile && !Profiler::writeChromeTrace("frameTrace.json")) {
+		std::cout << "Failed to write frameTrace.json" << std::endl;
 	}
+	Profiler::shutdown();
 
 	// Terminate
-	delete shader;
+	delete pacer;
+	delete frameUniforms;
+	delete shaders;
+	delete programCache;
 	terminateGLFW();
 	return 0;
 }
 
-void Input::handleKeyInput(glm::mat4 &t) {
-	if (Input::isKeyDown(GLFW_KEY_ESCAPE)) {
+// 6 units per second, what 0.1 per frame used to be at 60 fps
+void Input::handleKeyInput(glm::mat4 &t, float deltaSeconds) {
+	const float speed = 6.0f * deltaSeconds;
+	// A tap can start and end between two ticks
+	if (Input::wasKeyPressed(GLFW_KEY_ESCAPE)) {
 		Window::close();
 	}
-	if (Input::isKeyDown(GLFW_KEY_W)) {
-		t = glm::translate(t, glm::vec3(0.0f, 0.1f, 0.0f));
-	}
-	if (Input::isKeyDown(GLFW_KEY_S)) {
-		t = glm::translate(t, glm::vec3(0.0f, -0.1f, 0.0f));
-	}
-	if (Input::isKeyDown(GLFW_KEY_A)) {
-		t = glm::translate(t, glm::vec3(-0.1f, 0.0f, 0.0f));
-	}
-	if (Input::isKeyDown(GLFW_KEY_D)) {
-		t = glm::translate(t, glm::vec3(0.1f, 0.0f, 0.0f));
+	glm::vec3 direction = movementDirection(Input::isKeyDown);
+	if (direction != glm::vec3(0.0f)) {
+		t = glm::translate(t, direction * speed);
 	}
 }
 
+// WASD, per axis, from the tick state (isKeyDown) or the latest callbacks (isKeyHeldNow)
+glm::vec3 movementDirection(bool (*keyDown)(int)) {
+	glm::vec3 direction = glm::vec3(0.0f);
+	if (keyDown(GLFW_KEY_W)) direction.y += 1.0f;
+	if (keyDown(GLFW_KEY_S)) direction.y -= 1.0f;
+	if (keyDown(GLFW_KEY_A)) direction.x -= 1.0f;
+	if (keyDown(GLFW_KEY_D)) direction.x += 1.0f;
+	return direction;
+}
+
 void terminateGLFW() {
 	glfwDestroyWindow(Window::nativeWindow);
 	glfwTerminate();